@@ -1,15 +1,36 @@
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string_view>
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 
+#include "frame_capture.hpp"
+#include "gl_state.hpp"
+#include "loop_stats.hpp"
+#include "simulation.hpp"
+
 constexpr int width = 800;
 constexpr int height = 600;
 
+// reached from the GLFW callbacks through the window user pointer
+struct app {
+	simulation sim;
+	gl_state gl;
+};
+
+void framebuffer_size_callback(GLFWwindow* win, int w, int h) {
+	auto* a = static_cast<app*>(glfwGetWindowUserPointer(win));
+	a->gl.viewport(0, 0, w, h);
+	a->sim.push_input({input_action::resize, w, h, sim_clock::now()});
+}
 
-void framebuffer_size_callback([[maybe_unused]] GLFWwindow* win, int w, int h) {
-	glViewport(0, 0, w, h);
+void key_callback(GLFWwindow* win, int key, [[maybe_unused]] int scancode, int action, [[maybe_unused]] int mods) {
+	auto* a = static_cast<app*>(glfwGetWindowUserPointer(win));
+	if(key == GLFW_KEY_SPACE && action == GLFW_PRESS)
+		a->sim.push_input({input_action::toggle_animation, 0, 0, sim_clock::now()});
 }
 
 void process_input([[maybe_unused]] GLFWwindow* win) {
@@ -17,7 +38,17 @@ void process_input([[maybe_unused]] GLFWwindow* win) {
 		glfwSetWindowShouldClose(win, GLFW_TRUE);
 }
 
-int main([[maybe_unused]] int argc,[[maybe_unused]] char* argv[]) {
+int main(int argc, char* argv[]) {
+	// --capture <dir> writes frames there as PNG; frames are dropped rather
+	// than stalling the loop, the totals printed at exit say how many
+	const char* capture_dir = nullptr;
+	if(argc == 3 && std::string_view(argv[1]) == "--capture")
+		capture_dir = argv[2];
+	else if(argc != 1) {
+		std::cerr << "usage: " << argv[0] << " [--capture <dir>]\n";
+		return EXIT_FAILURE;
+	}
+
 	if(glfwInit() != GLFW_TRUE) {
 		std::cerr << "failed to init GLFW\n";
 		std::abort();
@@ -39,19 +70,66 @@ int main([[maybe_unused]] int argc,[[maybe_unused]] char* argv[]) {
 		std::abort();
 	}
 
+	// world updates run at a fixed rate on their own thread, this one only
+	// forwards input and draws the latest snapshot. GL state changes go
+	// through the cache so unchanged clear colors and viewports are dropped
+	app state;
+	auto& sim = state.sim;
+	auto& gl = state.gl;
+	sim.push_input({input_action::resize, width, height, sim_clock::now()});
+	glfwSetWindowUserPointer(window, &state);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetKeyCallback(window, key_callback);
+
+	gl.viewport(0, 0, width, height);
 
-	glViewport(0, 0, width, height);
+	std::unique_ptr<frame_capture> capture;
+	if(capture_dir) {
+		frame_capture_options capture_opts;
+		capture_opts.directory = capture_dir;
+		capture = std::make_unique<frame_capture>(capture_opts);
+	}
 
+	loop_stats stats;
+	std::size_t frame = 0;
 	while(!glfwWindowShouldClose(window)) {
 
 		glfwPollEvents();
 		process_input(window);
 
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		const auto& snap = sim.latest();
+		auto world = sim.interpolate(snap, sim_clock::now());
+
+		gl.clear_color(world.color[0], world.color[1], world.color[2], 1.0f);
+		gl.clear(GL_COLOR_BUFFER_BIT);
+
+		if(capture) {
+			int w = 0, h = 0;
+			glfwGetFramebufferSize(window, &w, &h);
+			// nothing to read while minimized
+			if(w > 0 && h > 0)
+				capture->capture(frame, w, h);
+		}
+		++frame;
 
 		glfwSwapBuffers(window);
+
+		auto now = sim_clock::now();
+		stats.frame_presented(now, sim.ticks(), snap.input_seq, snap.input_time);
+		if(auto report = stats.poll(now)) {
+			std::cout << "update " << report->update_hz << " Hz, render " << report->render_hz << " Hz";
+			if(report->latency_samples)
+				std::cout << ", input->present avg " << report->latency_avg_ms << " ms max " << report->latency_max_ms << " ms";
+			std::cout << "\n";
+		}
+	}
+
+	if(capture) {
+		capture->finish();
+		auto totals = capture->stats();
+		std::cout << "captured " << totals.written << " frames, dropped " << totals.dropped_busy + totals.dropped_queue + totals.dropped_map
+			<< ", readback latency avg " << totals.latency_avg_ms << " ms max " << totals.latency_max_ms << " ms\n";
+		capture.reset();
 	}
 
 	glfwDestroyWindow(window);
@@ -0,0 +1,34 @@
+#version 330 core
+
+// Variants toggle GRADIENT, STRIPES, VIGNETTE, NOISE and TINT.
+in vec2 v_uv;
+
+uniform float u_time;
+uniform vec4 u_tint;
+
+out vec4 frag_color;
+
+float hash(vec2 p) {
+	return fract(sin(dot(p, vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+void main() {
+	vec3 color = vec3(0.2, 0.3, 0.3);
+#ifdef GRADIENT
+	color = mix(color, vec3(v_uv, 0.5 + 0.5 * sin(u_time)), 0.6);
+#endif
+#ifdef STRIPES
+	color *= 0.8 + 0.2 * step(0.5, fract((v_uv.x + v_uv.y) * 16.0 + u_time * 0.5));
+#endif
+#ifdef VIGNETTE
+	vec2 d = v_uv - 0.5;
+	color *= 1.0 - dot(d, d) * 1.5;
+#endif
+#ifdef NOISE
+	color += (hash(gl_FragCoord.xy + u_time) - 0.5) * 0.05;
+#endif
+#ifdef TINT
+	color *= u_tint.rgb;
+#endif
+	frag_color = vec4(color, 1.0);
+}
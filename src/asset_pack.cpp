@@ -0,0 +1,208 @@
+#include "asset_pack.hpp"
+
+#include "hash.hpp"
+#include "lz4_block.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+static constexpr char pack_magic[4] = {'L', 'O', 'P', 'K'};
+static constexpr std::uint32_t pack_version = 1;
+static constexpr std::uint64_t payload_alignment = 64;
+
+static std::uint64_t align_up(std::uint64_t value, std::uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool entry_less(const asset_pack_entry& a, std::string_view a_name, const asset_pack_entry& b, std::string_view b_name) {
+	return a.name_hash != b.name_hash ? a.name_hash < b.name_hash : a_name < b_name;
+}
+
+static bool read_file(const std::string& path, std::vector<std::byte>& data) {
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if(!in)
+		return false;
+	data.resize(static_cast<std::size_t>(in.tellg()));
+	in.seekg(0);
+	return static_cast<bool>(in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+}
+
+bool write_asset_pack(const std::string& output, std::span<const asset_pack_source> sources, bool compress) {
+	struct packed {
+		asset_pack_entry entry{};
+		std::string_view name;
+		std::vector<std::byte> data;
+	};
+
+	std::vector<packed> items(sources.size());
+	for(std::size_t i = 0; i < sources.size(); ++i) {
+		auto& item = items[i];
+		item.name = sources[i].name;
+		if(!read_file(sources[i].path, item.data)) {
+			std::cerr << "failed to read " << sources[i].path << "\n";
+			return false;
+		}
+		item.entry.name_hash = fnv1a64(item.name);
+		item.entry.raw_size = item.data.size();
+		item.entry.compression = asset_compression::none;
+		if(compress && !item.data.empty()) {
+			auto compressed = lz4_compress(item.data);
+			if(compressed.size() <= item.data.size() - item.data.size() / 8) {
+				item.data = std::move(compressed);
+				item.entry.compression = asset_compression::lz4;
+			}
+		}
+		item.entry.size = item.data.size();
+	}
+
+	std::sort(items.begin(), items.end(), [](const packed& a, const packed& b) {
+		return entry_less(a.entry, a.name, b.entry, b.name);
+	});
+	for(std::size_t i = 1; i < items.size(); ++i) {
+		if(items[i].name == items[i - 1].name) {
+			std::cerr << "duplicate asset name " << items[i].name << "\n";
+			return false;
+		}
+	}
+
+	std::string names;
+	const auto names_offset = sizeof(asset_pack_header) + items.size() * sizeof(asset_pack_entry);
+	for(auto& item : items) {
+		item.entry.name_offset = static_cast<std::uint32_t>(names.size());
+		item.entry.name_size = static_cast<std::uint32_t>(item.name.size());
+		names += item.name;
+	}
+	auto offset = align_up(names_offset + names.size(), payload_alignment);
+	for(auto& item : items) {
+		item.entry.offset = offset;
+		offset = align_up(offset + item.entry.size, payload_alignment);
+	}
+
+	asset_pack_header header{};
+	std::memcpy(header.magic, pack_magic, sizeof(pack_magic));
+	header.version = pack_version;
+	header.entry_count = static_cast<std::uint32_t>(items.size());
+	header.names_offset = names_offset;
+	header.names_size = names.size();
+
+	// write next to the target and rename so readers never map a partial file
+	std::error_code ec;
+	if(auto parent = fs::path(output).parent_path(); !parent.empty())
+		fs::create_directories(parent, ec);
+	auto tmp = output + ".tmp";
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for(const auto& item : items)
+			out.write(reinterpret_cast<const char*>(&item.entry), sizeof(item.entry));
+		out.write(names.data(), static_cast<std::streamsize>(names.size()));
+		std::uint64_t written = names_offset + names.size();
+		static constexpr char padding[payload_alignment] = {};
+		for(const auto& item : items) {
+			out.write(padding, static_cast<std::streamsize>(item.entry.offset - written));
+			out.write(reinterpret_cast<const char*>(item.data.data()), static_cast<std::streamsize>(item.data.size()));
+			written = item.entry.offset + item.entry.size;
+		}
+		if(!out) {
+			std::cerr << "failed to write " << tmp << "\n";
+			return false;
+		}
+	}
+	fs::rename(tmp, output, ec);
+	if(ec) {
+		std::cerr << "failed to move " << tmp << " into place: " << ec.message() << "\n";
+		return false;
+	}
+	return true;
+}
+
+// Validates the header and index against the mapped size; returns why the
+// file is unusable, or nullptr.
+static const char* parse_index(const mapped_file& file, std::span<const asset_pack_entry>& entries, std::string_view& names) {
+	if(file.size() < sizeof(asset_pack_header))
+		return "not an asset pack";
+	const auto* header = reinterpret_cast<const asset_pack_header*>(file.data());
+	if(std::memcmp(header->magic, pack_magic, sizeof(pack_magic)) != 0 || header->version != pack_version)
+		return "not an asset pack";
+	const std::uint64_t table_end = sizeof(asset_pack_header) + std::uint64_t{header->entry_count} * sizeof(asset_pack_entry);
+	if(table_end > file.size() || header->names_offset < table_end || header->names_offset > file.size()
+		|| header->names_size > file.size() - header->names_offset)
+		return "truncated index";
+
+	std::span table(reinterpret_cast<const asset_pack_entry*>(header + 1), header->entry_count);
+	std::string_view all_names(reinterpret_cast<const char*>(file.data() + header->names_offset), header->names_size);
+	for(std::size_t i = 0; i < table.size(); ++i) {
+		const auto& e = table[i];
+		if(e.offset > file.size() || e.size > file.size() - e.offset)
+			return "entry out of bounds";
+		if(std::uint64_t{e.name_offset} + e.name_size > all_names.size())
+			return "entry name out of bounds";
+		if(e.compression == asset_compression::none ? e.raw_size != e.size : e.compression != asset_compression::lz4)
+			return "bad entry compression";
+		// lookups binary search, so the order has to hold
+		const auto& prev = table[i > 0 ? i - 1 : 0];
+		if(i > 0 && !entry_less(prev, all_names.substr(prev.name_offset, prev.name_size), e, all_names.substr(e.name_offset, e.name_size)))
+			return "index not sorted";
+	}
+	entries = table;
+	names = all_names;
+	return nullptr;
+}
+
+asset_pack::asset_pack(const std::string& path)
+	: file(path) {
+	if(!file.is_open()) {
+		std::cerr << "failed to open " << path << "\n";
+		return;
+	}
+	if(const char* error = parse_index(file, entries, names)) {
+		std::cerr << path << ": " << error << "\n";
+		file = mapped_file();
+	}
+}
+
+std::string_view asset_pack::name(const asset_pack_entry& entry) const {
+	return names.substr(entry.name_offset, entry.name_size);
+}
+
+const asset_pack_entry* asset_pack::find(std::string_view asset) const {
+	const auto hash = fnv1a64(asset);
+	auto it = std::lower_bound(entries.begin(), entries.end(), hash, [](const asset_pack_entry& e, std::uint64_t h) {
+		return e.name_hash < h;
+	});
+	for(; it != entries.end() && it->name_hash == hash; ++it) {
+		if(name(*it) == asset)
+			return &*it;
+	}
+	return nullptr;
+}
+
+std::span<const std::byte> asset_pack::view(std::string_view asset) const {
+	const auto* entry = find(asset);
+	if(!entry || entry->compression != asset_compression::none)
+		return {};
+	return file.bytes().subspan(entry->offset, entry->size);
+}
+
+bool asset_pack::load(std::string_view asset, asset_bytes& out) const {
+	const auto* entry = find(asset);
+	if(!entry)
+		return false;
+	auto stored = file.bytes().subspan(entry->offset, entry->size);
+	if(entry->compression == asset_compression::none) {
+		out = asset_bytes(stored);
+		return true;
+	}
+	std::vector<std::byte> data(entry->raw_size);
+	if(!lz4_decompress(stored, data)) {
+		std::cerr << "corrupt asset " << asset << "\n";
+		return false;
+	}
+	out = asset_bytes(std::move(data));
+	return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// All assets in one file, mapped once and handed out as views, so loading
+// doesn't cost an open/read/close per file.
+//
+// File layout (little endian):
+//   asset_pack_header
+//   asset_pack_entry[entry_count], sorted by name_hash, then name
+//   names, not null terminated
+//   payloads, each starting on a 64 byte boundary
+//
+// Entries are either stored as is or LZ4 block compressed (see lz4_block).
+// Names are paths relative to the packed directory with '/' separators.
+
+struct asset_pack_header {
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t entry_count;
+	std::uint32_t reserved;
+	std::uint64_t names_offset;
+	std::uint64_t names_size;
+};
+
+enum class asset_compression : std::uint32_t { none = 0, lz4 = 1 };
+
+struct asset_pack_entry {
+	std::uint64_t name_hash;
+	std::uint64_t offset;
+	std::uint64_t size;
+	std::uint64_t raw_size;
+	std::uint32_t name_offset;
+	std::uint32_t name_size;
+	asset_compression compression;
+	std::uint32_t reserved;
+};
+
+struct asset_pack_source {
+	std::string name;
+	std::string path;
+};
+
+// Reads every source and writes the pack. With compress, entries are stored
+// LZ4 compressed when that saves at least an eighth of their size; already
+// compressed formats like PNG usually don't.
+bool write_asset_pack(const std::string& output, std::span<const asset_pack_source> sources, bool compress);
+
+// The bytes of one asset: a view into the pack's mapping, or for compressed
+// entries the decompressed copy it owns.
+class asset_bytes {
+public:
+	asset_bytes() = default;
+	explicit asset_bytes(std::span<const std::byte> view) : view(view) {}
+	explicit asset_bytes(std::vector<std::byte> data) : storage(std::move(data)), view(storage) {}
+
+	asset_bytes(asset_bytes&&) noexcept = default;
+	asset_bytes& operator=(asset_bytes&&) noexcept = default;
+	asset_bytes(const asset_bytes&) = delete;
+	asset_bytes& operator=(const asset_bytes&) = delete;
+
+	std::span<const std::byte> bytes() const { return view; }
+	bool owned() const { return !storage.empty(); }
+
+private:
+	// moving a vector keeps its buffer, so view stays valid
+	std::vector<std::byte> storage;
+	std::span<const std::byte> view;
+};
+
+// Read-only and safe to use from any number of threads once opened.
+class asset_pack {
+public:
+	asset_pack() = default;
+	explicit asset_pack(const std::string& path);
+
+	bool is_open() const { return file.is_open(); }
+	std::size_t size() const { return entries.size(); }
+	std::span<const asset_pack_entry> index() const { return entries; }
+
+	const asset_pack_entry* find(std::string_view name) const;
+	std::string_view name(const asset_pack_entry& entry) const;
+
+	// Zero-copy view of an entry that is stored uncompressed, empty otherwise.
+	std::span<const std::byte> view(std::string_view name) const;
+
+	// The asset's bytes, decompressing on the calling thread if needed.
+	// Returns false when it's missing or corrupt.
+	bool load(std::string_view name, asset_bytes& out) const;
+
+private:
+	mapped_file file;
+	std::span<const asset_pack_entry> entries;
+	std::string_view names;
+};
@@ -0,0 +1,237 @@
+#include "batch_renderer.hpp"
+
+#include "shader.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static const char* instanced_vertex_source = R"(#version 330 core
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec4 i_position_scale;
+layout(location = 2) in float i_rotation;
+layout(location = 3) in vec4 i_color;
+
+uniform mat4 u_view_proj;
+
+out vec4 v_color;
+
+void main() {
+	float c = cos(i_rotation);
+	float s = sin(i_rotation);
+	vec3 p = vec3(mat2(c, s, -s, c) * a_position.xy, a_position.z);
+	gl_Position = u_view_proj * vec4(p * i_position_scale.w + i_position_scale.xyz, 1.0);
+	v_color = i_color;
+}
+)";
+
+static const char* instanced_fragment_source = R"(#version 330 core
+in vec4 v_color;
+
+uniform vec4 u_tint;
+
+out vec4 frag_color;
+
+void main() {
+	frag_color = v_color * u_tint;
+}
+)";
+
+static constexpr std::size_t array_alignment = 64;
+
+static std::size_t align_up(std::size_t value) {
+	return (value + array_alignment - 1) / array_alignment * array_alignment;
+}
+
+batch_renderer::batch_renderer(std::size_t section_bytes) {
+	default_program = create_program(instanced_vertex_source, instanced_fragment_source);
+	if(!default_program) {
+		std::cerr << "failed to build the instancing program\n";
+		std::abort();
+	}
+	grow(section_bytes);
+}
+
+batch_renderer::~batch_renderer() {
+	for(auto& fence : fences) {
+		if(fence)
+			glDeleteSync(fence);
+	}
+	glDeleteBuffers(1, &ring);
+	for(auto& m : meshes) {
+		glDeleteVertexArrays(1, &m.vao);
+		glDeleteBuffers(1, &m.vertices);
+		glDeleteBuffers(1, &m.indices);
+	}
+	glDeleteProgram(default_program);
+}
+
+mesh_id batch_renderer::add_mesh(std::span<const float> positions, std::span<const std::uint16_t> indices) {
+	mesh m;
+	m.index_count = static_cast<GLsizei>(indices.size());
+	glGenVertexArrays(1, &m.vao);
+	glBindVertexArray(m.vao);
+
+	glGenBuffers(1, &m.vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, m.vertices);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(positions.size_bytes()), positions.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+	glEnableVertexAttribArray(0);
+
+	glGenBuffers(1, &m.indices);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.indices);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size_bytes()), indices.data(), GL_STATIC_DRAW);
+
+	// instanced attributes; their pointers into the ring are set per draw
+	for(GLuint attrib = 1; attrib <= 3; ++attrib) {
+		glEnableVertexAttribArray(attrib);
+		glVertexAttribDivisor(attrib, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	meshes.push_back(m);
+	return static_cast<mesh_id>(meshes.size() - 1);
+}
+
+material_id batch_renderer::add_material(const float tint[4], GLuint program) {
+	material mat;
+	mat.program = program ? program : default_program;
+	mat.view_proj = glGetUniformLocation(mat.program, "u_view_proj");
+	mat.tint = glGetUniformLocation(mat.program, "u_tint");
+	std::memcpy(mat.color, tint, sizeof(mat.color));
+	materials.push_back(mat);
+	return static_cast<material_id>(materials.size() - 1);
+}
+
+void batch_renderer::submit(material_id material, mesh_id mesh, const float position[3], float scale, float rotation, std::uint32_t rgba) {
+	const auto key = std::uint64_t{material} << 32 | mesh;
+	auto [it, inserted] = batch_index.try_emplace(key, batches.size());
+	if(inserted) {
+		auto& b = batches.emplace_back();
+		b.material = material;
+		b.mesh = mesh;
+	}
+
+	auto& b = batches[it->second];
+	b.position_scale.insert(b.position_scale.end(), {position[0], position[1], position[2], scale});
+	b.rotation.push_back(rotation);
+	b.color.push_back(rgba);
+}
+
+void batch_renderer::grow(std::size_t section_bytes) {
+	// everything in flight reads the old buffer, let it finish first
+	for(int i = 0; i < sections; ++i) {
+		if(fences[i]) {
+			glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(fences[i]);
+			fences[i] = nullptr;
+		}
+	}
+	glDeleteBuffers(1, &ring);
+
+	section_size = align_up(section_bytes);
+	glGenBuffers(1, &ring);
+	glBindBuffer(GL_ARRAY_BUFFER, ring);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(section_size * sections), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	current_section = 0;
+}
+
+void batch_renderer::wait_for_section(int section) {
+	auto& fence = fences[section];
+	if(!fence)
+		return;
+	auto status = glClientWaitSync(fence, 0, 0);
+	if(status == GL_TIMEOUT_EXPIRED) {
+		++stats.fence_waits;
+		// one second per attempt, a lost context shouldn't hang us forever
+		while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED) {}
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void batch_renderer::flush(const float view_proj[16]) {
+	stats = {};
+
+	std::size_t needed = 0;
+	for(const auto& b : batches)
+		needed += align_up(b.rotation.size() * 4 * sizeof(float)) + align_up(b.rotation.size() * sizeof(float))
+			+ align_up(b.color.size() * sizeof(std::uint32_t));
+	if(needed == 0)
+		return;
+	if(needed > section_size)
+		grow(std::max(needed, section_size * 2));
+
+	wait_for_section(current_section);
+	const auto base = section_size * static_cast<std::size_t>(current_section);
+
+	glBindBuffer(GL_ARRAY_BUFFER, ring);
+	auto* mapped = static_cast<std::byte*>(glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(base),
+		static_cast<GLsizeiptr>(needed), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	if(!mapped) {
+		std::cerr << "failed to map instance buffer\n";
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return;
+	}
+
+	// copy every batch's arrays back to back and remember where they went
+	struct placement {
+		std::size_t position_scale, rotation, color;
+	};
+	std::vector<placement> placements(batches.size());
+	std::size_t offset = 0;
+	auto copy = [&](const auto& values) {
+		const auto at = offset;
+		const auto bytes = values.size() * sizeof(values[0]);
+		std::memcpy(mapped + at, values.data(), bytes);
+		offset += align_up(bytes);
+		return base + at;
+	};
+	for(std::size_t i = 0; i < batches.size(); ++i) {
+		placements[i].position_scale = copy(batches[i].position_scale);
+		placements[i].rotation = copy(batches[i].rotation);
+		placements[i].color = copy(batches[i].color);
+	}
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	stats.bytes_uploaded = offset;
+
+	GLuint bound_program = 0;
+	for(std::size_t i = 0; i < batches.size(); ++i) {
+		const auto& b = batches[i];
+		if(b.rotation.empty())
+			continue;
+		const auto& mat = materials[b.material];
+		const auto& m = meshes[b.mesh];
+		if(mat.program != bound_program) {
+			glUseProgram(mat.program);
+			glUniformMatrix4fv(mat.view_proj, 1, GL_FALSE, view_proj);
+			bound_program = mat.program;
+		}
+		glUniform4fv(mat.tint, 1, mat.color);
+
+		glBindVertexArray(m.vao);
+		const auto& p = placements[i];
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const void*>(p.position_scale));
+		glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const void*>(p.rotation));
+		glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, reinterpret_cast<const void*>(p.color));
+		glDrawElementsInstanced(GL_TRIANGLES, m.index_count, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(b.rotation.size()));
+
+		++stats.draw_calls;
+		stats.instances += b.rotation.size();
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	fences[current_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	current_section = (current_section + 1) % sections;
+
+	// keep the batches and their capacity, only drop this frame's instances
+	for(auto& b : batches) {
+		b.position_scale.clear();
+		b.rotation.clear();
+		b.color.clear();
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+using mesh_id = std::uint32_t;
+using material_id = std::uint32_t;
+
+struct batch_stats {
+	std::size_t draw_calls = 0;
+	std::size_t instances = 0;
+	std::size_t bytes_uploaded = 0;
+	// frames that had to wait for the GPU before reusing a ring section
+	std::size_t fence_waits = 0;
+};
+
+// Collects instances per (material, mesh) pair during the frame and draws
+// each pair with one glDrawElementsInstanced.
+//
+// Per-instance data is kept as separate arrays (position + scale, rotation,
+// color) and streamed every frame into one buffer split into three sections.
+// A section is written through an unsynchronized mapping, so the driver never
+// has to stall or copy; the fence placed after its draws is what keeps the CPU
+// from overwriting it while the GPU may still be reading it three frames later.
+//
+// Custom programs have to use the attribute locations of the built-in one:
+// 0 vec3 position, 1 vec4 instance position (xyz) + scale (w),
+// 2 float rotation around z, 3 vec4 color; plus mat4 u_view_proj and
+// vec4 u_tint uniforms.
+class batch_renderer {
+public:
+	explicit batch_renderer(std::size_t section_bytes = 4u << 20);
+	~batch_renderer();
+
+	batch_renderer(const batch_renderer&) = delete;
+	batch_renderer& operator=(const batch_renderer&) = delete;
+
+	mesh_id add_mesh(std::span<const float> positions, std::span<const std::uint16_t> indices);
+	// program 0 uses the built-in instancing program
+	material_id add_material(const float tint[4], GLuint program = 0);
+
+	void submit(material_id material, mesh_id mesh, const float position[3], float scale, float rotation, std::uint32_t rgba);
+
+	// Uploads everything submitted since the last flush and draws it.
+	// view_proj is column major.
+	void flush(const float view_proj[16]);
+
+	const batch_stats& last_frame() const { return stats; }
+
+private:
+	struct mesh {
+		GLuint vao = 0;
+		GLuint vertices = 0;
+		GLuint indices = 0;
+		GLsizei index_count = 0;
+	};
+
+	struct material {
+		GLuint program = 0;
+		GLint view_proj = -1;
+		GLint tint = -1;
+		float color[4] = {};
+	};
+
+	struct batch {
+		material_id material = 0;
+		mesh_id mesh = 0;
+		std::vector<float> position_scale;
+		std::vector<float> rotation;
+		std::vector<std::uint32_t> color;
+	};
+
+	static constexpr int sections = 3;
+
+	void grow(std::size_t section_bytes);
+	void wait_for_section(int section);
+
+	GLuint default_program = 0;
+	GLuint ring = 0;
+	std::size_t section_size = 0;
+	int current_section = 0;
+	GLsync fences[sections] = {};
+
+	std::vector<mesh> meshes;
+	std::vector<material> materials;
+	std::vector<batch> batches;
+	std::unordered_map<std::uint64_t, std::size_t> batch_index;
+	batch_stats stats;
+};
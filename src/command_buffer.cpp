@@ -0,0 +1,140 @@
+#include "command_buffer.hpp"
+
+#include "gl_state.hpp"
+#include "thread_pool.hpp"
+
+#include <bit>
+#include <latch>
+
+void command_buffer::push(op code, std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d, std::uint32_t e) {
+	commands.push_back({code, {a, b, c, d, e}});
+}
+
+std::uint32_t command_buffer::push_floats(const float* values, std::size_t count) {
+	auto offset = static_cast<std::uint32_t>(floats.size());
+	floats.insert(floats.end(), values, values + count);
+	return offset;
+}
+
+void command_buffer::use_program(GLuint program) {
+	push(op::use_program, program);
+}
+
+void command_buffer::bind_vertex_array(GLuint vao) {
+	push(op::bind_vertex_array, vao);
+}
+
+void command_buffer::bind_buffer(GLenum target, GLuint buffer) {
+	push(op::bind_buffer, target, buffer);
+}
+
+void command_buffer::bind_texture(GLuint unit, GLuint texture) {
+	push(op::bind_texture, unit, texture);
+}
+
+void command_buffer::viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+	push(op::viewport, std::bit_cast<std::uint32_t>(x), std::bit_cast<std::uint32_t>(y),
+		std::bit_cast<std::uint32_t>(w), std::bit_cast<std::uint32_t>(h));
+}
+
+void command_buffer::clear_color(float r, float g, float b, float a) {
+	const float c[4] = {r, g, b, a};
+	push(op::clear_color, push_floats(c, 4));
+}
+
+void command_buffer::set_enabled(GLenum capability, bool enabled) {
+	push(op::set_enabled, capability, enabled);
+}
+
+void command_buffer::blend_func(GLenum src, GLenum dst) {
+	push(op::blend_func, src, dst);
+}
+
+void command_buffer::uniform4f(GLint location, const float value[4]) {
+	push(op::uniform4f, std::bit_cast<std::uint32_t>(location), push_floats(value, 4));
+}
+
+void command_buffer::uniform_matrix4f(GLint location, const float value[16]) {
+	push(op::uniform_matrix4f, std::bit_cast<std::uint32_t>(location), push_floats(value, 16));
+}
+
+void command_buffer::clear(GLbitfield mask) {
+	push(op::clear, mask);
+}
+
+void command_buffer::draw_arrays(GLenum mode, GLint first, GLsizei count) {
+	push(op::draw_arrays, mode, std::bit_cast<std::uint32_t>(first), std::bit_cast<std::uint32_t>(count));
+}
+
+void command_buffer::draw_elements(GLenum mode, GLsizei count, GLenum type, std::uint32_t offset, GLsizei instances) {
+	push(op::draw_elements, mode, std::bit_cast<std::uint32_t>(count), type,
+		offset, std::bit_cast<std::uint32_t>(instances));
+}
+
+void command_buffer::execute(gl_state& state) const {
+	auto as_int = [](std::uint32_t v) { return std::bit_cast<GLint>(v); };
+	for(const auto& cmd : commands) {
+		const auto* a = cmd.args;
+		switch(cmd.code) {
+		case op::use_program:
+			state.use_program(a[0]);
+			break;
+		case op::bind_vertex_array:
+			state.bind_vertex_array(a[0]);
+			break;
+		case op::bind_buffer:
+			state.bind_buffer(a[0], a[1]);
+			break;
+		case op::bind_texture:
+			state.bind_texture(a[0], a[1]);
+			break;
+		case op::viewport:
+			state.viewport(as_int(a[0]), as_int(a[1]), as_int(a[2]), as_int(a[3]));
+			break;
+		case op::clear_color: {
+			const float* c = &floats[a[0]];
+			state.clear_color(c[0], c[1], c[2], c[3]);
+			break;
+		}
+		case op::set_enabled:
+			state.set_enabled(a[0], a[1] != 0);
+			break;
+		case op::blend_func:
+			state.blend_func(a[0], a[1]);
+			break;
+		case op::uniform4f:
+			state.uniform4f(as_int(a[0]), &floats[a[1]]);
+			break;
+		case op::uniform_matrix4f:
+			state.uniform_matrix4f(as_int(a[0]), &floats[a[1]]);
+			break;
+		case op::clear:
+			state.clear(a[0]);
+			break;
+		case op::draw_arrays:
+			state.draw_arrays(a[0], as_int(a[1]), as_int(a[2]));
+			break;
+		case op::draw_elements:
+			state.draw_elements(a[0], as_int(a[1]), a[2], a[3], as_int(a[4]));
+			break;
+		}
+	}
+}
+
+void command_buffer::reset() {
+	commands.clear();
+	floats.clear();
+}
+
+void record_parallel(thread_pool& pool, std::span<command_buffer> buffers,
+	const std::function<void(command_buffer&, std::size_t)>& record) {
+	std::latch done(static_cast<std::ptrdiff_t>(buffers.size()));
+	for(std::size_t i = 0; i < buffers.size(); ++i) {
+		pool.submit([&, i] {
+			buffers[i].reset();
+			record(buffers[i], i);
+			done.count_down();
+		});
+	}
+	done.wait();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+class gl_state;
+class thread_pool;
+
+// A list of GL calls recorded without touching GL, so any thread can fill
+// one, and replayed on the GL thread through a gl_state. Float arguments
+// live in a side array so commands stay a fixed size.
+class command_buffer {
+public:
+	void use_program(GLuint program);
+	void bind_vertex_array(GLuint vao);
+	void bind_buffer(GLenum target, GLuint buffer);
+	void bind_texture(GLuint unit, GLuint texture);
+	void viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+	void clear_color(float r, float g, float b, float a);
+	void set_enabled(GLenum capability, bool enabled);
+	void blend_func(GLenum src, GLenum dst);
+	void uniform4f(GLint location, const float value[4]);
+	void uniform_matrix4f(GLint location, const float value[16]);
+	void clear(GLbitfield mask);
+	void draw_arrays(GLenum mode, GLint first, GLsizei count);
+	// offset is a byte offset into the bound element buffer; commands store
+	// 32-bit words, so it is limited to 4 GiB
+	void draw_elements(GLenum mode, GLsizei count, GLenum type, std::uint32_t offset, GLsizei instances = 1);
+
+	// GL thread only
+	void execute(gl_state& state) const;
+
+	void reset();
+	std::size_t size() const { return commands.size(); }
+
+private:
+	enum class op : std::uint8_t {
+		use_program,
+		bind_vertex_array,
+		bind_buffer,
+		bind_texture,
+		viewport,
+		clear_color,
+		set_enabled,
+		blend_func,
+		uniform4f,
+		uniform_matrix4f,
+		clear,
+		draw_arrays,
+		draw_elements,
+	};
+
+	struct command {
+		op code;
+		std::uint32_t args[5];
+	};
+
+	void push(op code, std::uint32_t a = 0, std::uint32_t b = 0, std::uint32_t c = 0, std::uint32_t d = 0, std::uint32_t e = 0);
+	std::uint32_t push_floats(const float* values, std::size_t count);
+
+	std::vector<command> commands;
+	std::vector<float> floats;
+};
+
+// Resets every buffer and calls record(buffer, index) for each on the pool,
+// returning once all of them are done. Executing the buffers in span order
+// afterwards gives the same result as recording them one after another.
+void record_parallel(thread_pool& pool, std::span<command_buffer> buffers,
+	const std::function<void(command_buffer&, std::size_t)>& record);
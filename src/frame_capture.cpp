@@ -0,0 +1,207 @@
+#include "frame_capture.hpp"
+
+#include "png_writer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+frame_capture::frame_capture(frame_capture_options opts)
+	: opts(std::move(opts)) {
+	std::error_code ec;
+	fs::create_directories(this->opts.directory, ec);
+	if(ec)
+		std::cerr << "failed to create " << this->opts.directory << ": " << ec.message() << "\n";
+
+	slots.resize(std::max<std::size_t>(this->opts.buffers, 1));
+	for(auto& s : slots)
+		glGenBuffers(1, &s.buffer);
+	writer = std::jthread([this](std::stop_token stop) { write(stop); });
+}
+
+frame_capture::~frame_capture() {
+	finish();
+	writer.request_stop();
+	writer.join();
+	for(auto& s : slots) {
+		if(s.fence)
+			glDeleteSync(s.fence);
+		glDeleteBuffers(1, &s.buffer);
+	}
+}
+
+void frame_capture::capture(std::size_t frame, int width, int height) {
+	newest_frame = frame;
+	poll();
+	++counts.captured;
+
+	// the oldest readback is still in flight, waiting for it would stall;
+	// only lossless runs accept that
+	auto& s = slots[next];
+	if(s.fence && opts.lossless) {
+		glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		receive(s);
+	}
+	if(s.fence) {
+		++counts.dropped_busy;
+		return;
+	}
+
+	const auto bytes = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+	if(s.capacity < bytes) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+		s.capacity = bytes;
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	s.frame = frame;
+	s.width = width;
+	s.height = height;
+	s.issued = clock::now();
+	next = (next + 1) % slots.size();
+}
+
+void frame_capture::poll() {
+	// oldest first, so frames reach the writer in order
+	for(std::size_t i = 0; i < slots.size(); ++i) {
+		auto& s = slots[(next + i) % slots.size()];
+		if(!s.fence)
+			continue;
+		auto status = glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+		receive(s);
+	}
+}
+
+void frame_capture::receive(slot& s) {
+	glDeleteSync(s.fence);
+	s.fence = nullptr;
+
+	const double latency_ms = std::chrono::duration<double, std::milli>(clock::now() - s.issued).count();
+	latency_total_ms += latency_ms;
+	latency_total_frames += newest_frame - s.frame;
+	counts.latency_max_ms = std::max(counts.latency_max_ms, latency_ms);
+	++received;
+
+	captured_frame f;
+	{
+		std::unique_lock lock(mutex);
+		if(opts.lossless)
+			drained.wait(lock, [this] { return queue.size() < opts.queue_capacity; });
+		else if(queue.size() >= opts.queue_capacity) {
+			++counts.dropped_queue;
+			return;
+		}
+		if(!spare.empty()) {
+			f.pixels = std::move(spare.back());
+			spare.pop_back();
+		}
+	}
+
+	const auto bytes = static_cast<std::size_t>(s.width) * static_cast<std::size_t>(s.height) * 4;
+	f.frame = s.frame;
+	f.width = s.width;
+	f.height = s.height;
+	f.pixels.resize(bytes);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+	const auto* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+	if(mapped) {
+		std::memcpy(f.pixels.data(), mapped, bytes);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	if(!mapped) {
+		// the vector holds garbage or an older frame, never write it
+		++counts.dropped_map;
+		std::lock_guard lock(mutex);
+		if(spare.size() < opts.queue_capacity)
+			spare.push_back(std::move(f.pixels));
+		return;
+	}
+
+	{
+		std::lock_guard lock(mutex);
+		queue.push_back(std::move(f));
+	}
+	wake.notify_one();
+}
+
+void frame_capture::finish() {
+	for(std::size_t i = 0; i < slots.size(); ++i) {
+		auto& s = slots[(next + i) % slots.size()];
+		if(!s.fence)
+			continue;
+		glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		receive(s);
+	}
+
+	std::unique_lock lock(mutex);
+	drained.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+frame_capture_stats frame_capture::stats() const {
+	auto s = counts;
+	if(received) {
+		s.latency_avg_ms = latency_total_ms / static_cast<double>(received);
+		s.latency_avg_frames = static_cast<double>(latency_total_frames) / static_cast<double>(received);
+	}
+	std::lock_guard lock(mutex);
+	s.written = written;
+	s.write_failed = write_failed;
+	return s;
+}
+
+static bool write_raw(const std::string& path, int width, int height, const std::vector<std::uint8_t>& pixels) {
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	const auto stride = static_cast<std::size_t>(width) * 4;
+	// GL rows are bottom-up
+	for(int y = height - 1; y >= 0; --y)
+		out.write(reinterpret_cast<const char*>(pixels.data() + static_cast<std::size_t>(y) * stride), static_cast<std::streamsize>(stride));
+	return static_cast<bool>(out);
+}
+
+void frame_capture::write(std::stop_token stop) {
+	for(;;) {
+		captured_frame f;
+		{
+			std::unique_lock lock(mutex);
+			if(!wake.wait(lock, stop, [this] { return !queue.empty(); }))
+				return;
+			f = std::move(queue.front());
+			queue.pop_front();
+			writing = true;
+		}
+
+		char name[64];
+		bool ok = false;
+		if(opts.format == capture_format::png) {
+			std::snprintf(name, sizeof(name), "frame_%06zu.png", f.frame);
+			ok = write_png_rgba8((fs::path(opts.directory) / name).string(), f.width, f.height, f.pixels, true);
+		}
+		else {
+			std::snprintf(name, sizeof(name), "frame_%06zu_%dx%d.rgba", f.frame, f.width, f.height);
+			ok = write_raw((fs::path(opts.directory) / name).string(), f.width, f.height, f.pixels);
+		}
+
+		{
+			std::lock_guard lock(mutex);
+			writing = false;
+			if(ok)
+				++written;
+			else if(write_failed++ == 0)
+				std::cerr << "failed to write " << name << " to " << opts.directory << "\n";
+			if(spare.size() < opts.queue_capacity)
+				spare.push_back(std::move(f.pixels));
+		}
+		drained.notify_all();
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class capture_format { png, raw };
+
+struct frame_capture_options {
+	// frame_000042.png, or frame_000042_<w>x<h>.rgba for raw; rows top-down
+	std::string directory = "capture";
+	capture_format format = capture_format::png;
+	// pixel pack buffers in the ring. A buffer is mapped as soon as its
+	// fence has signaled, usually the next frame; more buffers only let the
+	// GPU fall further behind before frames get dropped
+	std::size_t buffers = 3;
+	// frames read back but not written yet; more are dropped
+	std::size_t queue_capacity = 8;
+	// Wait for the GPU and the writer instead of dropping, so every frame is
+	// written (barring map or write failures) and runs can be diffed frame by
+	// frame. Stalls the GL thread whenever either falls behind; meant for
+	// headless regression runs, not the interactive loop.
+	bool lossless = false;
+};
+
+struct frame_capture_stats {
+	std::size_t captured = 0;
+	std::size_t written = 0;
+	// dropped because all buffers were still in flight, the writer fell
+	// behind, or the buffer couldn't be mapped
+	std::size_t dropped_busy = 0;
+	std::size_t dropped_queue = 0;
+	std::size_t dropped_map = 0;
+	std::size_t write_failed = 0;
+	// from issuing the readback to having the pixels in memory
+	double latency_avg_ms = 0.0;
+	double latency_max_ms = 0.0;
+	double latency_avg_frames = 0.0;
+};
+
+// Copies frames out of the read framebuffer without stalling the GL thread.
+//
+// capture() issues glReadPixels into the next pixel pack buffer of a ring
+// and fences it. poll() maps the buffers whose fence has already signaled,
+// copies the pixels out and hands them to a writer thread that encodes them
+// to disk. If the next buffer is still in flight, or the writer's queue is
+// full, the frame is dropped and counted instead of waiting, unless the
+// lossless option is set.
+class frame_capture {
+public:
+	explicit frame_capture(frame_capture_options opts = {});
+	~frame_capture();
+
+	frame_capture(const frame_capture&) = delete;
+	frame_capture& operator=(const frame_capture&) = delete;
+
+	// Reads back the currently bound read framebuffer. Call after drawing,
+	// before the swap. Also polls.
+	void capture(std::size_t frame, int width, int height);
+
+	void poll();
+
+	// Waits for every readback and for the writer to drain; for shutdown.
+	void finish();
+
+	frame_capture_stats stats() const;
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	struct slot {
+		GLuint buffer = 0;
+		std::size_t capacity = 0;
+		GLsync fence = nullptr;
+		std::size_t frame = 0;
+		int width = 0;
+		int height = 0;
+		clock::time_point issued;
+	};
+
+	struct captured_frame {
+		std::size_t frame = 0;
+		int width = 0;
+		int height = 0;
+		std::vector<std::uint8_t> pixels;
+	};
+
+	void receive(slot& s);
+	void write(std::stop_token stop);
+
+	frame_capture_options opts;
+	std::vector<slot> slots;
+	std::size_t next = 0;
+	std::size_t newest_frame = 0;
+
+	frame_capture_stats counts;
+	double latency_total_ms = 0.0;
+	std::size_t latency_total_frames = 0;
+	std::size_t received = 0;
+
+	// shared with the writer thread
+	mutable std::mutex mutex;
+	std::condition_variable_any wake;
+	std::condition_variable_any drained;
+	std::deque<captured_frame> queue;
+	std::vector<std::vector<std::uint8_t>> spare;
+	bool writing = false;
+	std::size_t written = 0;
+	std::size_t write_failed = 0;
+	std::jthread writer;
+};
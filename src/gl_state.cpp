@@ -0,0 +1,141 @@
+#include "gl_state.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+bool gl_state::changed(GLuint& cached, GLuint value) {
+	if(cached == value) {
+		++calls.elided;
+		return false;
+	}
+	cached = value;
+	++calls.issued;
+	return true;
+}
+
+void gl_state::use_program(GLuint p) {
+	if(changed(program, p))
+		glUseProgram(p);
+}
+
+void gl_state::bind_vertex_array(GLuint v) {
+	if(changed(vao, v)) {
+		glBindVertexArray(v);
+		buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+	}
+}
+
+void gl_state::bind_buffer(GLenum target, GLuint buffer) {
+	auto [it, inserted] = buffers.try_emplace(target, unknown);
+	if(changed(it->second, buffer))
+		glBindBuffer(target, buffer);
+}
+
+void gl_state::bind_texture(GLuint unit, GLuint texture) {
+	if(unit >= texture_units) {
+		++calls.issued;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		active_unit = unit;
+		glBindTexture(GL_TEXTURE_2D, texture);
+		return;
+	}
+	if(textures[unit] == texture) {
+		++calls.elided;
+		return;
+	}
+	if(changed(active_unit, unit))
+		glActiveTexture(GL_TEXTURE0 + unit);
+	changed(textures[unit], texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void gl_state::viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+	const GLint v[4] = {x, y, w, h};
+	if(view_known && std::equal(v, v + 4, view)) {
+		++calls.elided;
+		return;
+	}
+	std::copy(v, v + 4, view);
+	view_known = true;
+	++calls.issued;
+	glViewport(x, y, w, h);
+}
+
+void gl_state::clear_color(float r, float g, float b, float a) {
+	const float c[4] = {r, g, b, a};
+	if(color_known && std::memcmp(c, color, sizeof(color)) == 0) {
+		++calls.elided;
+		return;
+	}
+	std::memcpy(color, c, sizeof(color));
+	color_known = true;
+	++calls.issued;
+	glClearColor(r, g, b, a);
+}
+
+void gl_state::set_enabled(GLenum capability, bool enabled) {
+	auto [it, inserted] = capabilities.try_emplace(capability, enabled);
+	if(!inserted && it->second == enabled) {
+		++calls.elided;
+		return;
+	}
+	it->second = enabled;
+	++calls.issued;
+	if(enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void gl_state::blend_func(GLenum src, GLenum dst) {
+	if(blend_known && blend[0] == src && blend[1] == dst) {
+		++calls.elided;
+		return;
+	}
+	blend[0] = src;
+	blend[1] = dst;
+	blend_known = true;
+	++calls.issued;
+	glBlendFunc(src, dst);
+}
+
+void gl_state::uniform4f(GLint location, const float value[4]) {
+	++calls.issued;
+	glUniform4fv(location, 1, value);
+}
+
+void gl_state::uniform_matrix4f(GLint location, const float value[16]) {
+	++calls.issued;
+	glUniformMatrix4fv(location, 1, GL_FALSE, value);
+}
+
+void gl_state::clear(GLbitfield mask) {
+	++calls.issued;
+	glClear(mask);
+}
+
+void gl_state::draw_arrays(GLenum mode, GLint first, GLsizei count) {
+	++calls.issued;
+	glDrawArrays(mode, first, count);
+}
+
+void gl_state::draw_elements(GLenum mode, GLsizei count, GLenum type, std::size_t offset, GLsizei instances) {
+	++calls.issued;
+	const auto* indices = reinterpret_cast<const void*>(offset);
+	if(instances == 1)
+		glDrawElements(mode, count, type, indices);
+	else
+		glDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+void gl_state::invalidate() {
+	program = unknown;
+	vao = unknown;
+	active_unit = unknown;
+	std::fill(std::begin(textures), std::end(textures), unknown);
+	buffers.clear();
+	capabilities.clear();
+	view_known = false;
+	color_known = false;
+	blend_known = false;
+}
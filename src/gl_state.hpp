@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <unordered_map>
+
+struct gl_call_counts {
+	std::size_t issued = 0;
+	std::size_t elided = 0;
+};
+
+// Shadows the GL state the renderer touches and drops calls that would set
+// it to the value it already has. Must only be used on the GL thread.
+//
+// The cache can only be trusted while everything goes through it: after
+// calling GL directly (or deleting an object that may still be bound, since
+// names get reused) call invalidate() and the next call of each kind is
+// issued unconditionally.
+//
+// Calls that aren't cached (clear, draws, uniforms) still go through here so
+// issued/elided give the full picture of a frame.
+class gl_state {
+public:
+	gl_state() { invalidate(); }
+
+	void use_program(GLuint program);
+	void bind_vertex_array(GLuint vao);
+	void bind_buffer(GLenum target, GLuint buffer);
+	// binds to GL_TEXTURE_2D on the given unit; other targets aren't cached
+	void bind_texture(GLuint unit, GLuint texture);
+	void viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+	void clear_color(float r, float g, float b, float a);
+	void set_enabled(GLenum capability, bool enabled);
+	void blend_func(GLenum src, GLenum dst);
+
+	void uniform4f(GLint location, const float value[4]);
+	void uniform_matrix4f(GLint location, const float value[16]);
+	void clear(GLbitfield mask);
+	void draw_arrays(GLenum mode, GLint first, GLsizei count);
+	void draw_elements(GLenum mode, GLsizei count, GLenum type, std::size_t offset, GLsizei instances = 1);
+
+	void invalidate();
+
+	const gl_call_counts& counts() const { return calls; }
+	void reset_counts() { calls = {}; }
+
+private:
+	static constexpr GLuint unknown = ~GLuint{0};
+	static constexpr int texture_units = 32;
+
+	bool changed(GLuint& cached, GLuint value);
+
+	GLuint program = unknown;
+	GLuint vao = unknown;
+	GLuint active_unit = unknown;
+	GLuint textures[texture_units];
+	// GL_ELEMENT_ARRAY_BUFFER is part of the VAO and forgotten when it changes
+	std::unordered_map<GLenum, GLuint> buffers;
+	std::unordered_map<GLenum, bool> capabilities;
+	GLint view[4] = {};
+	bool view_known = false;
+	float color[4] = {};
+	bool color_known = false;
+	GLenum blend[2] = {};
+	bool blend_known = false;
+
+	gl_call_counts calls;
+};
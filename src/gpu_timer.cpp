@@ -0,0 +1,53 @@
+#include "gpu_timer.hpp"
+
+gpu_timer::gpu_timer(std::size_t latency)
+	: slots(latency) {
+	for(auto& s : slots)
+		glGenQueries(1, &s.query);
+}
+
+gpu_timer::~gpu_timer() {
+	for(auto& s : slots)
+		glDeleteQueries(1, &s.query);
+}
+
+void gpu_timer::begin(std::size_t frame) {
+	current = frame % slots.size();
+	auto& s = slots[current];
+	// the ring wrapped before collect() saw this query, drop the stale result
+	// rather than stalling here
+	s.pending = false;
+	s.frame = frame;
+	s.discard = first;
+	first = false;
+	glBeginQuery(GL_TIME_ELAPSED, s.query);
+}
+
+void gpu_timer::end() {
+	glEndQuery(GL_TIME_ELAPSED);
+	slots[current].pending = true;
+}
+
+void gpu_timer::collect(std::vector<double>& results, bool wait) {
+	for(auto& s : slots) {
+		if(!s.pending)
+			continue;
+		if(!wait) {
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(s.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if(available != GL_TRUE)
+				continue;
+		}
+		resolve(s, results);
+	}
+}
+
+void gpu_timer::resolve(slot& s, std::vector<double>& results) {
+	GLuint64 ns = 0;
+	glGetQueryObjectui64v(s.query, GL_QUERY_RESULT, &ns);
+	s.pending = false;
+	if(s.discard)
+		return;
+	if(s.frame < results.size())
+		results[s.frame] = static_cast<double>(ns) / 1.0e6;
+}
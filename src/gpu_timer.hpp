@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+// Measures GPU time per frame with GL_TIME_ELAPSED queries. Queries are kept
+// in a ring and read back a few frames later so that reading a result never
+// waits on the GPU unless the ring wraps around onto an unfinished query.
+//
+// The first query a timer issues is discarded and its frame left unresolved:
+// llvmpipe reports a bogus elapsed time (seconds to hours) for it.
+class gpu_timer {
+public:
+	explicit gpu_timer(std::size_t latency = 4);
+	~gpu_timer();
+
+	gpu_timer(const gpu_timer&) = delete;
+	gpu_timer& operator=(const gpu_timer&) = delete;
+
+	void begin(std::size_t frame);
+	void end();
+
+	// Writes resolved timings (in milliseconds) into results[frame].
+	// With wait == false only queries whose result is already available are read.
+	void collect(std::vector<double>& results, bool wait = false);
+
+private:
+	struct slot {
+		GLuint query = 0;
+		std::size_t frame = 0;
+		bool pending = false;
+		bool discard = false;
+	};
+
+	void resolve(slot& s, std::vector<double>& results);
+
+	std::vector<slot> slots;
+	std::size_t current = 0;
+	bool first = true;
+};
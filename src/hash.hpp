@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// 64-bit FNV-1a. Not cryptographic, only used to detect changed inputs.
+constexpr std::uint64_t fnv1a_offset = 0xcbf29ce484222325ull;
+
+constexpr std::uint64_t fnv1a64(std::span<const std::byte> data, std::uint64_t hash = fnv1a_offset) {
+	for(auto b : data) {
+		hash ^= static_cast<std::uint64_t>(b);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+constexpr std::uint64_t fnv1a64(std::string_view str, std::uint64_t hash = fnv1a_offset) {
+	for(char c : str) {
+		hash ^= static_cast<std::uint8_t>(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
@@ -0,0 +1,68 @@
+#include "headless_context.hpp"
+
+#include <EGL/eglext.h>
+#include <iostream>
+
+static EGLDisplay get_surfaceless_display() {
+	auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+		eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if(get_platform_display) {
+		auto* display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		if(display != EGL_NO_DISPLAY)
+			return display;
+	}
+	// fall back to whatever the driver picks, still without a surface
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+std::optional<headless_context> create_headless_context(int major, int minor) {
+	headless_context ctx;
+	ctx.display = get_surfaceless_display();
+	if(ctx.display == EGL_NO_DISPLAY) {
+		std::cerr << "failed to get EGL display\n";
+		return std::nullopt;
+	}
+
+	EGLint egl_major = 0, egl_minor = 0;
+	if(eglInitialize(ctx.display, &egl_major, &egl_minor) != EGL_TRUE) {
+		std::cerr << "failed to init EGL: 0x" << std::hex << eglGetError() << std::dec << "\n";
+		return std::nullopt;
+	}
+
+	if(eglBindAPI(EGL_OPENGL_API) != EGL_TRUE) {
+		std::cerr << "EGL does not support desktop OpenGL\n";
+		eglTerminate(ctx.display);
+		return std::nullopt;
+	}
+
+	const EGLint context_attribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, major,
+		EGL_CONTEXT_MINOR_VERSION, minor,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE,
+	};
+	// EGL_KHR_no_config_context + EGL_KHR_surfaceless_context, both exposed by Mesa
+	ctx.context = eglCreateContext(ctx.display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attribs);
+	if(ctx.context == EGL_NO_CONTEXT) {
+		std::cerr << "failed to create EGL context: 0x" << std::hex << eglGetError() << std::dec << "\n";
+		eglTerminate(ctx.display);
+		return std::nullopt;
+	}
+
+	if(eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx.context) != EGL_TRUE) {
+		std::cerr << "failed to make EGL context current\n";
+		destroy_headless_context(ctx);
+		return std::nullopt;
+	}
+	return ctx;
+}
+
+void destroy_headless_context(headless_context& ctx) {
+	if(ctx.display == EGL_NO_DISPLAY)
+		return;
+	eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if(ctx.context != EGL_NO_CONTEXT)
+		eglDestroyContext(ctx.display, ctx.context);
+	eglTerminate(ctx.display);
+	ctx = {};
+}
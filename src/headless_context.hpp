@@ -0,0 +1,16 @@
+#pragma once
+
+#include <EGL/egl.h>
+
+#include <optional>
+
+// Surfaceless EGL context for running without a display server, e.g. on
+// build machines that only have Mesa's llvmpipe. Rendering has to go into an
+// offscreen framebuffer since there is no default one.
+struct headless_context {
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+};
+
+std::optional<headless_context> create_headless_context(int major, int minor);
+void destroy_headless_context(headless_context& ctx);
@@ -0,0 +1,45 @@
+#include "image_decode.hpp"
+
+#include "image_ops.hpp"
+
+#include <stb_image.h>
+
+static void free_stbi(std::uint8_t* pixels) {
+	stbi_image_free(pixels);
+}
+
+static void free_array(std::uint8_t* pixels) {
+	delete[] pixels;
+}
+
+rgba8_image decode_rgba8(std::span<const std::byte> encoded) {
+	rgba8_image image;
+	int channels = 0;
+	auto* data = reinterpret_cast<const stbi_uc*>(encoded.data());
+	const auto len = static_cast<int>(encoded.size());
+
+	// stb only converts gray+alpha itself, everything else is decoded as is
+	int info_w = 0, info_h = 0;
+	int desired = 0;
+	if(stbi_info_from_memory(data, len, &info_w, &info_h, &channels) && channels == 2)
+		desired = STBI_rgb_alpha;
+
+	auto* pixels = stbi_load_from_memory(data, len, &image.width, &image.height, &channels, desired);
+	if(!pixels) {
+		image.error = stbi_failure_reason();
+		return image;
+	}
+	if(desired == STBI_rgb_alpha || channels == 4) {
+		image.pixels = {pixels, free_stbi};
+		return image;
+	}
+
+	const auto count = static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height);
+	image.pixels = {new std::uint8_t[count * 4], free_array};
+	if(channels == 3)
+		expand_rgb_to_rgba8(pixels, image.pixels.get(), count);
+	else
+		expand_gray_to_rgba8(pixels, image.pixels.get(), count);
+	stbi_image_free(pixels);
+	return image;
+}
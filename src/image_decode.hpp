@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+struct rgba8_image {
+	using deleter = void (*)(std::uint8_t*);
+
+	int width = 0;
+	int height = 0;
+	std::unique_ptr<std::uint8_t, deleter> pixels{nullptr, nullptr};
+	// stb_image's reason when decoding failed
+	const char* error = nullptr;
+};
+
+// Decodes with stb_image in the file's own channel count and widens gray and
+// RGB images with the image_ops kernels, which is faster than letting stb
+// convert per pixel.
+rgba8_image decode_rgba8(std::span<const std::byte> encoded);
@@ -0,0 +1,287 @@
+#include "image_ops.hpp"
+
+#include "image_ops_kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#if defined(IMAGE_OPS_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+// ---- tables ----------------------------------------------------------------
+
+static const std::array<float, 512>& make_float_table() {
+	static const auto table = [] {
+		std::array<float, 512> t{};
+		for(int i = 0; i < 256; ++i) {
+			double c = i / 255.0;
+			c = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+			t[static_cast<std::size_t>(i)] = static_cast<float>(c);
+			t[static_cast<std::size_t>(256 + i)] = static_cast<float>(i / 255.0);
+		}
+		return t;
+	}();
+	return table;
+}
+
+static const std::array<std::uint8_t, linear_to_srgb_table_size + 3>& make_srgb_table() {
+	static const auto table = [] {
+		std::array<std::uint8_t, linear_to_srgb_table_size + 3> t{};
+		for(int i = 0; i < linear_to_srgb_table_size; ++i) {
+			double c = i / static_cast<double>(linear_to_srgb_scale);
+			c = c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+			t[static_cast<std::size_t>(i)] = static_cast<std::uint8_t>(std::lround(c * 255.0));
+		}
+		return t;
+	}();
+	return table;
+}
+
+const float* const rgba8_to_float_table = make_float_table().data();
+const std::uint8_t* const linear_to_srgb_table = make_srgb_table().data();
+
+// ---- scalar kernels ----------------------------------------------------------
+
+void scalar_expand_rgb(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	for(std::size_t i = 0; i < pixels; ++i, src += 3, dst += 4) {
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = src[2];
+		dst[3] = 255;
+	}
+}
+
+void scalar_expand_gray(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	for(std::size_t i = 0; i < pixels; ++i, dst += 4) {
+		dst[0] = dst[1] = dst[2] = src[i];
+		dst[3] = 255;
+	}
+}
+
+void scalar_srgb_to_linear(const std::uint8_t* src, float* dst, std::size_t pixels) {
+	for(std::size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+		dst[0] = rgba8_to_float_table[src[0]];
+		dst[1] = rgba8_to_float_table[src[1]];
+		dst[2] = rgba8_to_float_table[src[2]];
+		dst[3] = rgba8_to_float_table[256 + src[3]];
+	}
+}
+
+// Written to match maxps/minps/cvtps2dq exactly: NaN clamps to 0 and the
+// final rounding is to nearest even.
+static int quantize(float value, float scale) {
+	float c = value > 0.0f ? value : 0.0f;
+	c = c < 1.0f ? c : 1.0f;
+	return static_cast<int>(std::lrintf(c * scale));
+}
+
+void scalar_linear_to_srgb(const float* src, std::uint8_t* dst, std::size_t pixels) {
+	for(std::size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+		dst[0] = linear_to_srgb_table[quantize(src[0], linear_to_srgb_scale)];
+		dst[1] = linear_to_srgb_table[quantize(src[1], linear_to_srgb_scale)];
+		dst[2] = linear_to_srgb_table[quantize(src[2], linear_to_srgb_scale)];
+		dst[3] = static_cast<std::uint8_t>(quantize(src[3], 255.0f));
+	}
+}
+
+void scalar_premultiply(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	for(std::size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+		const unsigned a = src[3];
+		for(int c = 0; c < 3; ++c) {
+			// exact round(x / 255) for x = color * alpha
+			unsigned t = src[c] * a + 128;
+			dst[c] = static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+		}
+		dst[3] = static_cast<std::uint8_t>(a);
+	}
+}
+
+void scalar_box_range(const std::uint8_t* row0, const std::uint8_t* row1, int width, std::uint8_t* dst, int x_begin, int x_end) {
+	for(int x = x_begin; x < x_end; ++x) {
+		const int x0 = std::min(2 * x, width - 1) * 4;
+		const int x1 = std::min(2 * x + 1, width - 1) * 4;
+		for(int c = 0; c < 4; ++c) {
+			unsigned sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+			dst[x * 4 + c] = static_cast<std::uint8_t>((sum + 2) >> 2);
+		}
+	}
+}
+
+void scalar_kaiser_horizontal_range(const std::uint8_t* row, int width, std::int16_t* out, int x_begin, int x_end) {
+	for(int x = x_begin; x < x_end; ++x) {
+		for(int c = 0; c < 4; ++c) {
+			int sum = 0;
+			for(int k = 0; k < kaiser_taps; ++k) {
+				const int sx = std::clamp(2 * x - 2 + k, 0, width - 1);
+				sum += kaiser_weights[k] * row[sx * 4 + c];
+			}
+			out[x * 4 + c] = static_cast<std::int16_t>(sum);
+		}
+	}
+}
+
+void scalar_kaiser_vertical_range(const std::int16_t* const* rows, std::uint8_t* out, int x_begin, int x_end) {
+	for(int i = x_begin * 4; i < x_end * 4; ++i) {
+		int sum = 0;
+		for(int k = 0; k < kaiser_taps; ++k)
+			sum += kaiser_weights[k] * rows[k][i];
+		out[i] = static_cast<std::uint8_t>(std::clamp((sum + (1 << (kaiser_shift - 1))) >> kaiser_shift, 0, 255));
+	}
+}
+
+static void scalar_box_row(const std::uint8_t* row0, const std::uint8_t* row1, int width, std::uint8_t* dst) {
+	scalar_box_range(row0, row1, width, dst, 0, std::max(1, width / 2));
+}
+
+static void scalar_kaiser_horizontal(const std::uint8_t* row, int width, std::int16_t* out) {
+	scalar_kaiser_horizontal_range(row, width, out, 0, std::max(1, width / 2));
+}
+
+static void scalar_kaiser_vertical(const std::int16_t* const* rows, int dst_width, std::uint8_t* out) {
+	scalar_kaiser_vertical_range(rows, out, 0, dst_width);
+}
+
+const image_kernels scalar_image_kernels = {
+	scalar_expand_rgb,
+	scalar_expand_gray,
+	scalar_srgb_to_linear,
+	scalar_linear_to_srgb,
+	scalar_premultiply,
+	scalar_box_row,
+	scalar_kaiser_horizontal,
+	scalar_kaiser_vertical,
+};
+
+// ---- dispatch ----------------------------------------------------------------
+
+static simd_level detect_simd_level() {
+#if defined(IMAGE_OPS_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] >= 7) {
+		__cpuid(info, 1);
+		const bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		if(os_saves_ymm && (info[1] & (1 << 5)))
+			return simd_level::avx2;
+	}
+	return simd_level::sse2;
+#else
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		return simd_level::avx2;
+	return simd_level::sse2;
+#endif
+#else
+	return simd_level::scalar;
+#endif
+}
+
+static const image_kernels& kernels_for(simd_level level) {
+	switch(level) {
+#if defined(IMAGE_OPS_X86)
+	case simd_level::avx2: return avx2_image_kernels;
+	case simd_level::sse2: return sse2_image_kernels;
+#endif
+	default: return scalar_image_kernels;
+	}
+}
+
+static std::atomic<simd_level>& current_level() {
+	static std::atomic<simd_level> level{supported_simd_level()};
+	return level;
+}
+
+static const image_kernels& kernels() {
+	return kernels_for(current_level().load(std::memory_order_relaxed));
+}
+
+const char* simd_level_name(simd_level level) {
+	switch(level) {
+	case simd_level::scalar: return "scalar";
+	case simd_level::sse2: return "sse2";
+	case simd_level::avx2: return "avx2";
+	}
+	return "unknown";
+}
+
+simd_level supported_simd_level() {
+	static const simd_level level = detect_simd_level();
+	return level;
+}
+
+simd_level active_simd_level() {
+	return current_level().load(std::memory_order_relaxed);
+}
+
+simd_level set_simd_level(simd_level level) {
+	level = std::min(level, supported_simd_level());
+	current_level().store(level, std::memory_order_relaxed);
+	return level;
+}
+
+// ---- entry points ------------------------------------------------------------
+
+void expand_rgb_to_rgba8(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	kernels().expand_rgb(src, dst, pixels);
+}
+
+void expand_gray_to_rgba8(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	kernels().expand_gray(src, dst, pixels);
+}
+
+void srgb_to_linear_rgba8(const std::uint8_t* src, float* dst, std::size_t pixels) {
+	kernels().srgb_to_linear(src, dst, pixels);
+}
+
+void linear_to_srgb_rgba8(const float* src, std::uint8_t* dst, std::size_t pixels) {
+	kernels().linear_to_srgb(src, dst, pixels);
+}
+
+void premultiply_alpha_rgba8(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	kernels().premultiply(src, dst, pixels);
+}
+
+int mip_level_count(int width, int height) {
+	int levels = 1;
+	for(int size = std::max(width, height); size > 1; size /= 2)
+		++levels;
+	return levels;
+}
+
+void downsample_box_rgba8(const std::uint8_t* src, int width, int height, std::uint8_t* dst) {
+	const auto& k = kernels();
+	const int dst_w = std::max(1, width / 2);
+	const int dst_h = std::max(1, height / 2);
+	const auto stride = static_cast<std::size_t>(width) * 4;
+	for(int y = 0; y < dst_h; ++y) {
+		const auto* row0 = src + static_cast<std::size_t>(std::min(2 * y, height - 1)) * stride;
+		const auto* row1 = src + static_cast<std::size_t>(std::min(2 * y + 1, height - 1)) * stride;
+		k.box_row(row0, row1, width, dst + static_cast<std::size_t>(y) * dst_w * 4);
+	}
+}
+
+void downsample_kaiser_rgba8(const std::uint8_t* src, int width, int height, std::uint8_t* dst) {
+	const auto& k = kernels();
+	const int dst_w = std::max(1, width / 2);
+	const int dst_h = std::max(1, height / 2);
+	const auto src_stride = static_cast<std::size_t>(width) * 4;
+	const auto dst_stride = static_cast<std::size_t>(dst_w) * 4;
+
+	std::vector<std::int16_t> filtered(static_cast<std::size_t>(height) * dst_stride);
+	for(int y = 0; y < height; ++y)
+		k.kaiser_horizontal(src + y * src_stride, width, filtered.data() + y * dst_stride);
+
+	const std::int16_t* rows[kaiser_taps];
+	for(int y = 0; y < dst_h; ++y) {
+		for(int t = 0; t < kaiser_taps; ++t)
+			rows[t] = filtered.data() + static_cast<std::size_t>(std::clamp(2 * y - 2 + t, 0, height - 1)) * dst_stride;
+		k.kaiser_vertical(rows, dst_w, dst + y * dst_stride);
+	}
+}
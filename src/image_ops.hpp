@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel format conversion and mip downsampling for RGBA8 images.
+//
+// Every kernel has a scalar implementation plus SSE2 and AVX2 versions on x86;
+// the widest one the CPU supports is picked on first use. All versions do the
+// same integer arithmetic so their output is bit-identical to the scalar one.
+
+enum class simd_level { scalar, sse2, avx2 };
+
+const char* simd_level_name(simd_level level);
+simd_level supported_simd_level();
+simd_level active_simd_level();
+// Clamped to what the CPU supports; returns the level actually selected.
+simd_level set_simd_level(simd_level level);
+
+// 3 channel RGB / 1 channel gray to RGBA8 with opaque alpha.
+void expand_rgb_to_rgba8(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+void expand_gray_to_rgba8(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+
+// sRGB encoded RGBA8 to linear float RGBA, alpha is scaled to [0, 1].
+void srgb_to_linear_rgba8(const std::uint8_t* src, float* dst, std::size_t pixels);
+// Linear float RGBA to sRGB encoded RGBA8. Color goes through a 4096 entry
+// table, which stays within one code of the exact conversion.
+void linear_to_srgb_rgba8(const float* src, std::uint8_t* dst, std::size_t pixels);
+
+// color = round(color * alpha / 255), alpha is kept. src and dst may alias.
+void premultiply_alpha_rgba8(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+
+// Number of levels in a full mip chain down to 1x1.
+int mip_level_count(int width, int height);
+
+// Halve an RGBA8 image. dst must hold max(1, width / 2) * max(1, height / 2)
+// pixels.
+// The box filter averages 2x2 blocks; on odd sizes the last row/column is
+// dropped (a 1 pixel wide or tall image is averaged with itself).
+// The Kaiser filter is a 6 tap windowed sinc that keeps more detail in the
+// smaller levels; its taps clamp at the edges, so on odd sizes the last
+// row/column still contributes to the outermost output pixels.
+void downsample_box_rgba8(const std::uint8_t* src, int width, int height, std::uint8_t* dst);
+void downsample_kaiser_rgba8(const std::uint8_t* src, int width, int height, std::uint8_t* dst);
@@ -0,0 +1,198 @@
+// AVX2 kernels, see image_ops_kernels.hpp for why nothing here may use the
+// standard library.
+#include "image_ops_kernels.hpp"
+
+#if defined(IMAGE_OPS_X86)
+
+#include <immintrin.h>
+
+namespace {
+
+__m256i load2x128(const std::uint8_t* lo, const std::uint8_t* hi) {
+	return _mm256_inserti128_si256(
+		_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo))),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)), 1);
+}
+
+void expand_rgb(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	const __m256i shuffle = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+	std::size_t i = 0;
+	// 8 pixels per step, the second half's load ends 4 bytes past them
+	for(; (i + 8) * 3 + 4 <= pixels * 3; i += 8) {
+		const __m256i x = load2x128(src + i * 3, src + i * 3 + 12);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+			_mm256_or_si256(_mm256_shuffle_epi8(x, shuffle), alpha));
+	}
+	scalar_expand_rgb(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void expand_gray(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	const __m256i shuffle_lo = _mm256_setr_epi8(
+		0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1,
+		4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+	const __m256i shuffle_hi = _mm256_setr_epi8(
+		8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1,
+		12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+	const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+	std::size_t i = 0;
+	for(; i + 16 <= pixels; i += 16) {
+		const __m256i g = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+		auto* out = reinterpret_cast<__m256i*>(dst + i * 4);
+		_mm256_storeu_si256(out + 0, _mm256_or_si256(_mm256_shuffle_epi8(g, shuffle_lo), alpha));
+		_mm256_storeu_si256(out + 1, _mm256_or_si256(_mm256_shuffle_epi8(g, shuffle_hi), alpha));
+	}
+	scalar_expand_gray(src + i, dst + i * 4, pixels - i);
+}
+
+void srgb_to_linear(const std::uint8_t* src, float* dst, std::size_t pixels) {
+	// alpha lanes look up the second half of the table
+	const __m256i alpha_offset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+	std::size_t i = 0;
+	for(; i + 2 <= pixels; i += 2) {
+		const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i * 4));
+		const __m256i idx = _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), alpha_offset);
+		_mm256_storeu_ps(dst + i * 4, _mm256_i32gather_ps(rgba8_to_float_table, idx, 4));
+	}
+	scalar_srgb_to_linear(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// Two pixels to 8 lanes of 32 bit codes.
+__m256i linear_to_srgb_pair(const float* src) {
+	const __m256 scale = _mm256_setr_ps(
+		linear_to_srgb_scale, linear_to_srgb_scale, linear_to_srgb_scale, 255.0f,
+		linear_to_srgb_scale, linear_to_srgb_scale, linear_to_srgb_scale, 255.0f);
+	__m256 c = _mm256_max_ps(_mm256_loadu_ps(src), _mm256_setzero_ps());
+	c = _mm256_min_ps(c, _mm256_set1_ps(1.0f));
+	const __m256i idx = _mm256_cvtps_epi32(_mm256_mul_ps(c, scale));
+	const __m256i color = _mm256_and_si256(
+		_mm256_i32gather_epi32(reinterpret_cast<const int*>(linear_to_srgb_table), idx, 1),
+		_mm256_set1_epi32(0xff));
+	return _mm256_blend_epi32(color, idx, 0x88);
+}
+
+void linear_to_srgb(const float* src, std::uint8_t* dst, std::size_t pixels) {
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	std::size_t i = 0;
+	for(; i + 8 <= pixels; i += 8) {
+		const float* s = src + i * 4;
+		// lanes end up as [p0 p2 p4 p6 | p1 p3 p5 p7] after the two packs
+		const __m256i a = _mm256_packus_epi32(linear_to_srgb_pair(s), linear_to_srgb_pair(s + 8));
+		const __m256i b = _mm256_packus_epi32(linear_to_srgb_pair(s + 16), linear_to_srgb_pair(s + 24));
+		const __m256i packed = _mm256_packus_epi16(a, b);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_permutevar8x32_epi32(packed, order));
+	}
+	scalar_linear_to_srgb(src + i * 4, dst + i * 4, pixels - i);
+}
+
+__m256i premultiply_quad(__m256i px, __m256i keep_color, __m256i alpha_one) {
+	__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	a = _mm256_or_si256(_mm256_and_si256(a, keep_color), alpha_one);
+	const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(px, a), _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+void premultiply(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i keep_color = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+	const __m256i alpha_one = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+	std::size_t i = 0;
+	for(; i + 8 <= pixels; i += 8) {
+		const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+		// unpack and pack both work per 128 bit lane, so pixel order survives
+		const __m256i lo = premultiply_quad(_mm256_unpacklo_epi8(x, zero), keep_color, alpha_one);
+		const __m256i hi = premultiply_quad(_mm256_unpackhi_epi8(x, zero), keep_color, alpha_one);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_packus_epi16(lo, hi));
+	}
+	scalar_premultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// 8 pixels to 4 pair sums in 16 bit lanes, [d0 d1 | d2 d3].
+__m256i pair_sum(__m256i px) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i even = _mm256_unpacklo_epi8(_mm256_shuffle_epi32(px, _MM_SHUFFLE(2, 0, 2, 0)), zero);
+	const __m256i odd = _mm256_unpacklo_epi8(_mm256_shuffle_epi32(px, _MM_SHUFFLE(3, 1, 3, 1)), zero);
+	return _mm256_add_epi16(even, odd);
+}
+
+void box_row(const std::uint8_t* row0, const std::uint8_t* row1, int width, std::uint8_t* dst) {
+	const int dst_w = width / 2 > 0 ? width / 2 : 1;
+	const __m256i two = _mm256_set1_epi16(2);
+	int x = 0;
+	for(; width >= 2 && x + 8 <= dst_w; x += 8) {
+		const auto* a0 = reinterpret_cast<const __m256i*>(row0 + x * 8);
+		const auto* a1 = reinterpret_cast<const __m256i*>(row1 + x * 8);
+		__m256i lo = _mm256_add_epi16(pair_sum(_mm256_loadu_si256(a0)), pair_sum(_mm256_loadu_si256(a1)));
+		__m256i hi = _mm256_add_epi16(pair_sum(_mm256_loadu_si256(a0 + 1)), pair_sum(_mm256_loadu_si256(a1 + 1)));
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2);
+		// [d0 d1 d4 d5 | d2 d3 d6 d7] back into order
+		const __m256i packed = _mm256_packus_epi16(lo, hi);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+	scalar_box_range(row0, row1, width, dst, x, dst_w);
+}
+
+void kaiser_horizontal(const std::uint8_t* row, int width, std::int16_t* out) {
+	const int dst_w = width / 2 > 0 ? width / 2 : 1;
+	const __m256i zero = _mm256_setzero_si256();
+	const int x_begin = dst_w > 1 ? 1 : dst_w;
+	int x = x_begin;
+	// four output pixels per step; the last load ends at source pixel 2x + 10
+	for(; x + 4 <= dst_w && 2 * x + 10 < width; x += 4) {
+		__m256i sum = zero;
+		for(int k = 0; k < kaiser_taps; ++k) {
+			const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + (2 * x - 2 + k) * 4));
+			const __m256i taps = _mm256_unpacklo_epi8(_mm256_shuffle_epi32(px, _MM_SHUFFLE(2, 0, 2, 0)), zero);
+			sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(taps, _mm256_set1_epi16(kaiser_weights[k])));
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), sum);
+	}
+	scalar_kaiser_horizontal_range(row, width, out, 0, x_begin);
+	scalar_kaiser_horizontal_range(row, width, out, x, dst_w);
+}
+
+__m256i weight_pair(int k) {
+	return _mm256_set1_epi32(static_cast<int>(static_cast<std::uint16_t>(kaiser_weights[k])
+		| static_cast<std::uint32_t>(static_cast<std::uint16_t>(kaiser_weights[k + 1])) << 16));
+}
+
+void kaiser_vertical(const std::int16_t* const* rows, int dst_width, std::uint8_t* out) {
+	const __m256i round = _mm256_set1_epi32(1 << (kaiser_shift - 1));
+	const __m256i w01 = weight_pair(0), w23 = weight_pair(2), w45 = weight_pair(4);
+	int x = 0;
+	for(; x + 4 <= dst_width; x += 4) {
+		__m256i r[kaiser_taps];
+		for(int k = 0; k < kaiser_taps; ++k)
+			r[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + x * 4));
+		__m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(r[0], r[1]), w01);
+		lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(r[2], r[3]), w23));
+		lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(r[4], r[5]), w45));
+		__m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(r[0], r[1]), w01);
+		hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(r[2], r[3]), w23));
+		hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(r[4], r[5]), w45));
+		lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), kaiser_shift);
+		hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), kaiser_shift);
+		const __m256i packed = _mm256_packs_epi32(lo, hi);
+		const __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, packed), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm256_castsi256_si128(bytes));
+	}
+	scalar_kaiser_vertical_range(rows, out, x, dst_width);
+}
+
+} // namespace
+
+const image_kernels avx2_image_kernels = {
+	expand_rgb,
+	expand_gray,
+	srgb_to_linear,
+	linear_to_srgb,
+	premultiply,
+	box_row,
+	kaiser_horizontal,
+	kaiser_vertical,
+};
+
+#endif
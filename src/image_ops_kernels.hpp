@@ -0,0 +1,58 @@
+#pragma once
+
+// Shared between image_ops.cpp and the per instruction set translation units.
+// Those are compiled with different target flags, so they must not pull in
+// inline code (standard library templates included) that the linker could
+// pick for the rest of the program; everything they need from the scalar side
+// is declared here as out-of-line functions and tables.
+
+#include <cstddef>
+#include <cstdint>
+
+struct image_kernels {
+	void (*expand_rgb)(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+	void (*expand_gray)(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+	void (*srgb_to_linear)(const std::uint8_t* src, float* dst, std::size_t pixels);
+	void (*linear_to_srgb)(const float* src, std::uint8_t* dst, std::size_t pixels);
+	void (*premultiply)(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+	// One destination row of the 2x2 box filter from two source rows of
+	// `width` pixels (the same row twice for 1 pixel tall images).
+	void (*box_row)(const std::uint8_t* row0, const std::uint8_t* row1, int width, std::uint8_t* dst);
+	// Horizontal Kaiser pass over one source row into max(1, width / 2)
+	// 16 bit RGBA sums.
+	void (*kaiser_horizontal)(const std::uint8_t* row, int width, std::int16_t* out);
+	// Vertical Kaiser pass combining kaiser_taps horizontally filtered rows.
+	void (*kaiser_vertical)(const std::int16_t* const* rows, int dst_width, std::uint8_t* out);
+};
+
+extern const image_kernels scalar_image_kernels;
+#if defined(IMAGE_OPS_X86)
+extern const image_kernels sse2_image_kernels;
+extern const image_kernels avx2_image_kernels;
+#endif
+
+// [0, 256): sRGB code to linear color, [256, 512): alpha code / 255
+extern const float* const rgba8_to_float_table;
+// Indexed by round(clamp(linear, 0, 1) * linear_to_srgb_scale). Padded by
+// three bytes so 32 bit gathers from the last entry stay in bounds.
+constexpr int linear_to_srgb_table_size = 4096;
+constexpr float linear_to_srgb_scale = static_cast<float>(linear_to_srgb_table_size - 1);
+extern const std::uint8_t* const linear_to_srgb_table;
+
+// Kaiser windowed sinc (beta 4, radius 3) for 2:1 decimation in 6 bit fixed
+// point, taps at 2x-2 .. 2x+3. Weights sum to 64 per axis; the horizontal pass
+// keeps the 16 bit sums, the vertical one rounds away the remaining 12 bits.
+constexpr int kaiser_taps = 6;
+constexpr std::int16_t kaiser_weights[kaiser_taps] = {-1, 6, 27, 27, 6, -1};
+constexpr int kaiser_shift = 12;
+
+// Scalar versions over a range of pixels, used by the SIMD kernels for
+// borders and tails.
+void scalar_expand_rgb(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+void scalar_expand_gray(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+void scalar_srgb_to_linear(const std::uint8_t* src, float* dst, std::size_t pixels);
+void scalar_linear_to_srgb(const float* src, std::uint8_t* dst, std::size_t pixels);
+void scalar_premultiply(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+void scalar_box_range(const std::uint8_t* row0, const std::uint8_t* row1, int width, std::uint8_t* dst, int x_begin, int x_end);
+void scalar_kaiser_horizontal_range(const std::uint8_t* row, int width, std::int16_t* out, int x_begin, int x_end);
+void scalar_kaiser_vertical_range(const std::int16_t* const* rows, std::uint8_t* out, int x_begin, int x_end);
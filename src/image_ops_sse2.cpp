@@ -0,0 +1,169 @@
+// SSE2 kernels, see image_ops_kernels.hpp for why nothing here may use the
+// standard library.
+#include "image_ops_kernels.hpp"
+
+#if defined(IMAGE_OPS_X86)
+
+#include <emmintrin.h>
+
+namespace {
+
+void expand_rgb(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+	std::size_t i = 0;
+	// each 16 byte load covers 4 pixels plus 4 bytes that get overwritten by
+	// alpha, so stop while the load still ends inside the source
+	for(; (i + 4) * 3 + 4 <= pixels * 3; i += 4) {
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+		const __m128i p01 = _mm_unpacklo_epi32(x, _mm_srli_si128(x, 3));
+		const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(x, 6), _mm_srli_si128(x, 9));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_unpacklo_epi64(p01, p23), alpha));
+	}
+	scalar_expand_rgb(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void expand_gray(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	const __m128i ones = _mm_set1_epi8(static_cast<char>(0xff));
+	std::size_t i = 0;
+	for(; i + 16 <= pixels; i += 16) {
+		const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const __m128i gg_lo = _mm_unpacklo_epi8(g, g);
+		const __m128i gg_hi = _mm_unpackhi_epi8(g, g);
+		const __m128i ga_lo = _mm_unpacklo_epi8(g, ones);
+		const __m128i ga_hi = _mm_unpackhi_epi8(g, ones);
+		auto* out = reinterpret_cast<__m128i*>(dst + i * 4);
+		_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(gg_lo, ga_lo));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gg_lo, ga_lo));
+		_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(gg_hi, ga_hi));
+		_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(gg_hi, ga_hi));
+	}
+	scalar_expand_gray(src + i, dst + i * 4, pixels - i);
+}
+
+void linear_to_srgb(const float* src, std::uint8_t* dst, std::size_t pixels) {
+	// without a gather only the clamp and rounding are vectorized
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_setr_ps(linear_to_srgb_scale, linear_to_srgb_scale, linear_to_srgb_scale, 255.0f);
+	alignas(16) std::int32_t idx[4];
+	for(std::size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+		__m128 c = _mm_max_ps(_mm_loadu_ps(src), zero);
+		c = _mm_min_ps(c, one);
+		_mm_store_si128(reinterpret_cast<__m128i*>(idx), _mm_cvtps_epi32(_mm_mul_ps(c, scale)));
+		dst[0] = linear_to_srgb_table[idx[0]];
+		dst[1] = linear_to_srgb_table[idx[1]];
+		dst[2] = linear_to_srgb_table[idx[2]];
+		dst[3] = static_cast<std::uint8_t>(idx[3]);
+	}
+}
+
+// Two pixels widened to 16 bit lanes.
+__m128i premultiply_pair(__m128i px, __m128i keep_color, __m128i alpha_one) {
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	// alpha times 255 reproduces itself through the division below
+	a = _mm_or_si128(_mm_and_si128(a, keep_color), alpha_one);
+	const __m128i t = _mm_add_epi16(_mm_mullo_epi16(px, a), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+void premultiply(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i keep_color = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+	const __m128i alpha_one = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+	std::size_t i = 0;
+	for(; i + 4 <= pixels; i += 4) {
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+		const __m128i lo = premultiply_pair(_mm_unpacklo_epi8(x, zero), keep_color, alpha_one);
+		const __m128i hi = premultiply_pair(_mm_unpackhi_epi8(x, zero), keep_color, alpha_one);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(lo, hi));
+	}
+	scalar_premultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// Sums horizontally adjacent pixel pairs of 4 pixels into 2 pixels of 16 bit lanes.
+__m128i pair_sum(__m128i px) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i even = _mm_unpacklo_epi8(_mm_shuffle_epi32(px, _MM_SHUFFLE(2, 0, 2, 0)), zero);
+	const __m128i odd = _mm_unpacklo_epi8(_mm_shuffle_epi32(px, _MM_SHUFFLE(3, 1, 3, 1)), zero);
+	return _mm_add_epi16(even, odd);
+}
+
+void box_row(const std::uint8_t* row0, const std::uint8_t* row1, int width, std::uint8_t* dst) {
+	const int dst_w = width / 2 > 0 ? width / 2 : 1;
+	const __m128i two = _mm_set1_epi16(2);
+	int x = 0;
+	// every destination pixel has both source columns inside the row here
+	for(; width >= 2 && x + 4 <= dst_w; x += 4) {
+		const auto* a0 = reinterpret_cast<const __m128i*>(row0 + x * 8);
+		const auto* a1 = reinterpret_cast<const __m128i*>(row1 + x * 8);
+		__m128i lo = _mm_add_epi16(pair_sum(_mm_loadu_si128(a0)), pair_sum(_mm_loadu_si128(a1)));
+		__m128i hi = _mm_add_epi16(pair_sum(_mm_loadu_si128(a0 + 1)), pair_sum(_mm_loadu_si128(a1 + 1)));
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(lo, hi));
+	}
+	scalar_box_range(row0, row1, width, dst, x, dst_w);
+}
+
+void kaiser_horizontal(const std::uint8_t* row, int width, std::int16_t* out) {
+	const int dst_w = width / 2 > 0 ? width / 2 : 1;
+	const __m128i zero = _mm_setzero_si128();
+	// the first output pixel reads left of the row, handle it with clamping
+	const int x_begin = dst_w > 1 ? 1 : dst_w;
+	int x = x_begin;
+	// two output pixels per step; the last load ends at source pixel 2x + 6
+	for(; x + 2 <= dst_w && 2 * x + 6 < width; x += 2) {
+		__m128i sum = zero;
+		for(int k = 0; k < kaiser_taps; ++k) {
+			const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + (2 * x - 2 + k) * 4));
+			const __m128i taps = _mm_unpacklo_epi8(_mm_shuffle_epi32(px, _MM_SHUFFLE(2, 0, 2, 0)), zero);
+			sum = _mm_add_epi16(sum, _mm_mullo_epi16(taps, _mm_set1_epi16(kaiser_weights[k])));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), sum);
+	}
+	scalar_kaiser_horizontal_range(row, width, out, 0, x_begin);
+	scalar_kaiser_horizontal_range(row, width, out, x, dst_w);
+}
+
+__m128i weight_pair(int k) {
+	return _mm_set1_epi32(static_cast<int>(static_cast<std::uint16_t>(kaiser_weights[k])
+		| static_cast<std::uint32_t>(static_cast<std::uint16_t>(kaiser_weights[k + 1])) << 16));
+}
+
+void kaiser_vertical(const std::int16_t* const* rows, int dst_width, std::uint8_t* out) {
+	const __m128i round = _mm_set1_epi32(1 << (kaiser_shift - 1));
+	const __m128i w01 = weight_pair(0), w23 = weight_pair(2), w45 = weight_pair(4);
+	int x = 0;
+	for(; x + 2 <= dst_width; x += 2) {
+		__m128i r[kaiser_taps];
+		for(int k = 0; k < kaiser_taps; ++k)
+			r[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + x * 4));
+		__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(r[0], r[1]), w01);
+		lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(r[2], r[3]), w23));
+		lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(r[4], r[5]), w45));
+		__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(r[0], r[1]), w01);
+		hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(r[2], r[3]), w23));
+		hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(r[4], r[5]), w45));
+		lo = _mm_srai_epi32(_mm_add_epi32(lo, round), kaiser_shift);
+		hi = _mm_srai_epi32(_mm_add_epi32(hi, round), kaiser_shift);
+		const __m128i packed = _mm_packs_epi32(lo, hi);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(packed, packed));
+	}
+	scalar_kaiser_vertical_range(rows, out, x, dst_width);
+}
+
+} // namespace
+
+// table lookups without a gather instruction gain nothing over the scalar loop
+const image_kernels sse2_image_kernels = {
+	expand_rgb,
+	expand_gray,
+	scalar_srgb_to_linear,
+	linear_to_srgb,
+	premultiply,
+	box_row,
+	kaiser_horizontal,
+	kaiser_vertical,
+};
+
+#endif
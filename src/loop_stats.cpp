@@ -0,0 +1,58 @@
+#include "loop_stats.hpp"
+
+#include <algorithm>
+
+loop_stats::loop_stats(clock::duration interval)
+	: interval(interval) {}
+
+void loop_stats::frame_presented(clock::time_point now, std::uint64_t ticks, std::uint64_t input_seq, clock::time_point input_time) {
+	// time and ticks both count from the first frame, so whatever ran before
+	// it (startup, benchmark warmup) doesn't skew the rates
+	if(!started) {
+		started = true;
+		current.start = overall.start = now;
+		current.start_ticks = overall.start_ticks = ticks;
+	}
+	last_ticks = ticks;
+	++current.frames;
+	++overall.frames;
+
+	if(input_seq == seen_input_seq)
+		return;
+	seen_input_seq = input_seq;
+	const double ms = std::chrono::duration<double, std::milli>(now - input_time).count();
+	for(auto* w : {&current, &overall}) {
+		w->latency_sum_ms += ms;
+		w->latency_max_ms = std::max(w->latency_max_ms, ms);
+		++w->latency_samples;
+	}
+}
+
+std::optional<loop_stats_report> loop_stats::poll(clock::time_point now) {
+	if(!started || now - current.start < interval)
+		return std::nullopt;
+	auto report = summarize(current, now, last_ticks);
+	current = {};
+	current.start = now;
+	current.start_ticks = last_ticks;
+	return report;
+}
+
+loop_stats_report loop_stats::totals(clock::time_point now) const {
+	return summarize(overall, now, last_ticks);
+}
+
+loop_stats_report loop_stats::summarize(const window& w, clock::time_point now, std::uint64_t ticks) {
+	loop_stats_report r;
+	const double seconds = std::chrono::duration<double>(now - w.start).count();
+	if(seconds > 0.0) {
+		r.update_hz = static_cast<double>(ticks - w.start_ticks) / seconds;
+		r.render_hz = static_cast<double>(w.frames) / seconds;
+	}
+	r.latency_samples = w.latency_samples;
+	if(w.latency_samples) {
+		r.latency_avg_ms = w.latency_sum_ms / static_cast<double>(w.latency_samples);
+		r.latency_max_ms = w.latency_max_ms;
+	}
+	return r;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+struct loop_stats_report {
+	double update_hz = 0.0;
+	double render_hz = 0.0;
+	// input event to the first presented frame that reflects it
+	double latency_avg_ms = 0.0;
+	double latency_max_ms = 0.0;
+	std::uint64_t latency_samples = 0;
+};
+
+// Render thread side bookkeeping for the decoupled loop: frame rate, the
+// simulation's tick rate and input-to-present latency, summarized once per
+// interval.
+class loop_stats {
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit loop_stats(clock::duration interval = std::chrono::seconds(5));
+
+	// Call right after presenting. input_seq/input_time come from the
+	// snapshot that was drawn; ticks is the simulation's running tick count.
+	void frame_presented(clock::time_point now, std::uint64_t ticks, std::uint64_t input_seq, clock::time_point input_time);
+
+	// Returns a report when an interval has elapsed since the last one.
+	std::optional<loop_stats_report> poll(clock::time_point now);
+
+	// Totals since the first frame_presented(), for the benchmark report.
+	loop_stats_report totals(clock::time_point now) const;
+
+private:
+	struct window {
+		clock::time_point start;
+		std::uint64_t start_ticks = 0;
+		std::uint64_t frames = 0;
+		double latency_sum_ms = 0.0;
+		double latency_max_ms = 0.0;
+		std::uint64_t latency_samples = 0;
+	};
+
+	static loop_stats_report summarize(const window& w, clock::time_point now, std::uint64_t ticks);
+
+	clock::duration interval;
+	window current;
+	window overall;
+	std::uint64_t last_ticks = 0;
+	std::uint64_t seen_input_seq = 0;
+	bool started = false;
+};
@@ -0,0 +1,143 @@
+#include "lz4_block.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+static constexpr std::size_t min_match = 4;
+// the spec keeps the last 5 bytes as literals and starts no match in the
+// last 12, which lets real decoders copy in wide chunks
+static constexpr std::size_t last_literals = 5;
+static constexpr std::size_t match_limit = 12;
+static constexpr std::size_t max_offset = 65535;
+static constexpr int hash_bits = 16;
+
+static std::uint32_t read32(const std::uint8_t* p) {
+	std::uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static std::uint32_t hash4(std::uint32_t v) {
+	return (v * 2654435761u) >> (32 - hash_bits);
+}
+
+static void put_length(std::vector<std::byte>& out, std::size_t length) {
+	for(; length >= 255; length -= 255)
+		out.push_back(std::byte{255});
+	out.push_back(static_cast<std::byte>(length));
+}
+
+static void put_sequence(std::vector<std::byte>& out, const std::uint8_t* literals, std::size_t literal_count,
+	std::size_t offset, std::size_t match_length) {
+	const std::size_t lit_nibble = literal_count < 15 ? literal_count : 15;
+	std::size_t match_nibble = 0;
+	if(match_length)
+		match_nibble = match_length - min_match < 15 ? match_length - min_match : 15;
+	out.push_back(static_cast<std::byte>(lit_nibble << 4 | match_nibble));
+	if(lit_nibble == 15)
+		put_length(out, literal_count - 15);
+	const auto* lit = reinterpret_cast<const std::byte*>(literals);
+	out.insert(out.end(), lit, lit + literal_count);
+	if(!match_length)
+		return;
+	out.push_back(static_cast<std::byte>(offset & 0xff));
+	out.push_back(static_cast<std::byte>(offset >> 8));
+	if(match_nibble == 15)
+		put_length(out, match_length - min_match - 15);
+}
+
+std::vector<std::byte> lz4_compress(std::span<const std::byte> src) {
+	const auto* in = reinterpret_cast<const std::uint8_t*>(src.data());
+	const std::size_t n = src.size();
+
+	std::vector<std::byte> out;
+	out.reserve(n + n / 255 + 16);
+
+	// positions + 1, so 0 means empty
+	std::vector<std::uint32_t> table(std::size_t{1} << hash_bits, 0);
+	std::size_t anchor = 0;
+	std::size_t i = 0;
+	while(n >= match_limit + 1 && i + match_limit <= n) {
+		const auto v = read32(in + i);
+		auto& slot = table[hash4(v)];
+		const std::size_t candidate = slot;
+		slot = static_cast<std::uint32_t>(i + 1);
+		if(candidate == 0 || i - (candidate - 1) > max_offset || read32(in + candidate - 1) != v) {
+			++i;
+			continue;
+		}
+
+		const std::size_t match = candidate - 1;
+		std::size_t length = min_match;
+		while(i + length < n - last_literals && in[match + length] == in[i + length])
+			++length;
+		put_sequence(out, in + anchor, i - anchor, i - match, length);
+		i += length;
+		anchor = i;
+	}
+	put_sequence(out, in + anchor, n - anchor, 0, 0);
+	return out;
+}
+
+bool lz4_decompress(std::span<const std::byte> src, std::span<std::byte> dst) {
+	const auto* ip = reinterpret_cast<const std::uint8_t*>(src.data());
+	const auto* const iend = ip + src.size();
+	auto* op = reinterpret_cast<std::uint8_t*>(dst.data());
+	auto* const ostart = op;
+	auto* const oend = op + dst.size();
+
+	auto read_length = [&](std::size_t& length) {
+		for(;;) {
+			if(ip == iend)
+				return false;
+			const std::uint8_t b = *ip++;
+			length += b;
+			if(b != 255)
+				return true;
+		}
+	};
+
+	while(ip < iend) {
+		const std::uint8_t token = *ip++;
+
+		std::size_t literal_count = token >> 4;
+		if(literal_count == 15 && !read_length(literal_count))
+			return false;
+		if(literal_count > static_cast<std::size_t>(iend - ip) || literal_count > static_cast<std::size_t>(oend - op))
+			return false;
+		if(literal_count)
+			std::memcpy(op, ip, literal_count);
+		ip += literal_count;
+		op += literal_count;
+
+		// the last sequence has literals only
+		if(ip == iend)
+			break;
+
+		if(iend - ip < 2)
+			return false;
+		const std::size_t offset = std::size_t{ip[0]} | std::size_t{ip[1]} << 8;
+		ip += 2;
+		if(offset == 0 || offset > static_cast<std::size_t>(op - ostart))
+			return false;
+
+		std::size_t length = token & 15;
+		if(length == 15 && !read_length(length))
+			return false;
+		length += min_match;
+		if(length > static_cast<std::size_t>(oend - op))
+			return false;
+
+		const auto* match = op - offset;
+		if(offset >= length) {
+			std::memcpy(op, match, length);
+			op += length;
+		}
+		else {
+			// overlapping copy repeats the last offset bytes
+			for(std::size_t k = 0; k < length; ++k)
+				*op++ = match[k];
+		}
+	}
+	return op == oend;
+}
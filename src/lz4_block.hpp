@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// LZ4 block format (no frame header or checksums), compatible with
+// LZ4_compress_default / LZ4_decompress_safe. The compressor is the simple
+// greedy single-probe kind: fast and decent, nowhere near lz4hc.
+
+std::vector<std::byte> lz4_compress(std::span<const std::byte> src);
+
+// dst has to be exactly the uncompressed size. Returns false on malformed
+// input instead of reading or writing out of bounds.
+bool lz4_decompress(std::span<const std::byte> src, std::span<std::byte> dst);
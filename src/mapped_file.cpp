@@ -0,0 +1,115 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+mapped_file::mapped_file(const std::string& path) {
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		file = nullptr;
+		return;
+	}
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		close();
+		return;
+	}
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!mapping) {
+		close();
+		return;
+	}
+	data_ = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if(!data_) {
+		close();
+		return;
+	}
+	size_ = static_cast<std::size_t>(size.QuadPart);
+}
+
+void mapped_file::close() {
+	if(data_)
+		UnmapViewOfFile(data_);
+	if(mapping)
+		CloseHandle(mapping);
+	if(file)
+		CloseHandle(file);
+	data_ = nullptr;
+	size_ = 0;
+	mapping = nullptr;
+	file = nullptr;
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+	: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+	file(std::exchange(other.file, nullptr)), mapping(std::exchange(other.mapping, nullptr)) {}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+	if(this != &other) {
+		close();
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+		file = std::exchange(other.file, nullptr);
+		mapping = std::exchange(other.mapping, nullptr);
+	}
+	return *this;
+}
+
+#else
+
+mapped_file::mapped_file(const std::string& path) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+		return;
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return;
+	}
+	auto size = static_cast<std::size_t>(st.st_size);
+	void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps the file alive
+	::close(fd);
+	if(ptr == MAP_FAILED)
+		return;
+	data_ = static_cast<const std::byte*>(ptr);
+	size_ = size;
+}
+
+void mapped_file::close() {
+	if(data_)
+		munmap(const_cast<std::byte*>(data_), size_);
+	data_ = nullptr;
+	size_ = 0;
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+	: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+	if(this != &other) {
+		close();
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+	}
+	return *this;
+}
+
+#endif
+
+mapped_file::~mapped_file() {
+	close();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+class mapped_file {
+public:
+	mapped_file() = default;
+	explicit mapped_file(const std::string& path);
+	~mapped_file();
+
+	mapped_file(mapped_file&& other) noexcept;
+	mapped_file& operator=(mapped_file&& other) noexcept;
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	bool is_open() const { return data_ != nullptr; }
+	const std::byte* data() const { return data_; }
+	std::size_t size() const { return size_; }
+	std::span<const std::byte> bytes() const { return {data_, size_}; }
+
+private:
+	void close();
+
+	const std::byte* data_ = nullptr;
+	std::size_t size_ = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+};
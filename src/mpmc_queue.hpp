@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+// Bounded lock-free multi-producer/multi-consumer queue (Dmitry Vyukov's
+// sequence-numbered ring). Capacity is rounded up to a power of two.
+// try_push/try_pop never block; callers decide how to back off.
+template<typename T>
+class mpmc_queue {
+public:
+	explicit mpmc_queue(std::size_t capacity)
+		: mask(round_up_pow2(capacity) - 1), cells(new cell[mask + 1]) {
+		for(std::size_t i = 0; i <= mask; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	mpmc_queue(const mpmc_queue&) = delete;
+	mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+	bool try_push(T&& value) {
+		auto pos = tail.load(std::memory_order_relaxed);
+		for(;;) {
+			auto& c = cells[pos & mask];
+			auto seq = c.sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+			if(diff == 0) {
+				if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					c.value = std::move(value);
+					c.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if(diff < 0)
+				return false; // full
+			else
+				pos = tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::optional<T> try_pop() {
+		auto pos = head.load(std::memory_order_relaxed);
+		for(;;) {
+			auto& c = cells[pos & mask];
+			auto seq = c.sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+			if(diff == 0) {
+				if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					std::optional<T> value(std::move(c.value));
+					c.sequence.store(pos + mask + 1, std::memory_order_release);
+					return value;
+				}
+			}
+			else if(diff < 0)
+				return std::nullopt; // empty
+			else
+				pos = head.load(std::memory_order_relaxed);
+		}
+	}
+
+private:
+	static std::size_t round_up_pow2(std::size_t n) {
+		std::size_t p = 2;
+		while(p < n)
+			p <<= 1;
+		return p;
+	}
+
+	struct cell {
+		std::atomic<std::size_t> sequence;
+		T value{};
+	};
+
+	// keep producers and consumers off each other's cache line
+	static constexpr std::size_t cache_line = 64;
+
+	const std::size_t mask;
+	std::unique_ptr<cell[]> cells;
+	alignas(cache_line) std::atomic<std::size_t> tail{0};
+	alignas(cache_line) std::atomic<std::size_t> head{0};
+};
@@ -0,0 +1,37 @@
+#include "offscreen_target.hpp"
+
+#include <iostream>
+
+bool create_offscreen_target(offscreen_target& target, int w, int h) {
+	target.width = w;
+	target.height = h;
+
+	glGenRenderbuffers(1, &target.color);
+	glBindRenderbuffer(GL_RENDERBUFFER, target.color);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+
+	glGenRenderbuffers(1, &target.depth_stencil);
+	glBindRenderbuffer(GL_RENDERBUFFER, target.depth_stencil);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &target.fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.color);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depth_stencil);
+
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "offscreen framebuffer is incomplete\n";
+		destroy_offscreen_target(target);
+		return false;
+	}
+	return true;
+}
+
+void destroy_offscreen_target(offscreen_target& target) {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &target.fbo);
+	glDeleteRenderbuffers(1, &target.color);
+	glDeleteRenderbuffers(1, &target.depth_stencil);
+	target = {};
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Color + depth/stencil framebuffer object used in place of the window's
+// default framebuffer when running headless.
+struct offscreen_target {
+	GLuint fbo = 0;
+	GLuint color = 0;
+	GLuint depth_stencil = 0;
+	int width = 0;
+	int height = 0;
+};
+
+bool create_offscreen_target(offscreen_target& target, int w, int h);
+void destroy_offscreen_target(offscreen_target& target);
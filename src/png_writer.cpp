@@ -0,0 +1,110 @@
+#include "png_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <vector>
+
+static constexpr std::array<std::uint32_t, 256> crc_table = [] {
+	std::array<std::uint32_t, 256> table{};
+	for(std::uint32_t n = 0; n < 256; ++n) {
+		std::uint32_t c = n;
+		for(int k = 0; k < 8; ++k)
+			c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+		table[n] = c;
+	}
+	return table;
+}();
+
+static std::uint32_t crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0) {
+	crc = ~crc;
+	for(std::size_t i = 0; i < size; ++i)
+		crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+static std::uint32_t adler32(const std::uint8_t* data, std::size_t size) {
+	std::uint32_t a = 1, b = 0;
+	while(size > 0) {
+		// largest run that can't overflow b before the modulo
+		const auto n = std::min<std::size_t>(size, 5552);
+		for(std::size_t i = 0; i < n; ++i) {
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += n;
+		size -= n;
+	}
+	return b << 16 | a;
+}
+
+static void put_u32_be(std::vector<std::uint8_t>& out, std::uint32_t v) {
+	out.push_back(static_cast<std::uint8_t>(v >> 24));
+	out.push_back(static_cast<std::uint8_t>(v >> 16));
+	out.push_back(static_cast<std::uint8_t>(v >> 8));
+	out.push_back(static_cast<std::uint8_t>(v));
+}
+
+static void put_chunk(std::vector<std::uint8_t>& out, const char type[4], const std::vector<std::uint8_t>& data) {
+	put_u32_be(out, static_cast<std::uint32_t>(data.size()));
+	const auto start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data.begin(), data.end());
+	put_u32_be(out, crc32(out.data() + start, out.size() - start));
+}
+
+bool write_png_rgba8(const std::string& path, int width, int height, std::span<const std::uint8_t> pixels, bool flip_rows) {
+	const auto stride = static_cast<std::size_t>(width) * 4;
+	if(width <= 0 || height <= 0 || pixels.size() < stride * static_cast<std::size_t>(height))
+		return false;
+
+	// filter type 0 (none) in front of every row
+	std::vector<std::uint8_t> scanlines;
+	scanlines.reserve((stride + 1) * static_cast<std::size_t>(height));
+	for(int y = 0; y < height; ++y) {
+		const auto row = static_cast<std::size_t>(flip_rows ? height - 1 - y : y);
+		scanlines.push_back(0);
+		scanlines.insert(scanlines.end(), pixels.begin() + static_cast<std::ptrdiff_t>(row * stride),
+			pixels.begin() + static_cast<std::ptrdiff_t>((row + 1) * stride));
+	}
+
+	// zlib stream of stored deflate blocks, at most 65535 bytes each
+	std::vector<std::uint8_t> idat;
+	idat.reserve(scanlines.size() + scanlines.size() / 65535 * 5 + 16);
+	idat.push_back(0x78);
+	idat.push_back(0x01);
+	for(std::size_t pos = 0;;) {
+		const auto len = static_cast<std::uint16_t>(std::min<std::size_t>(scanlines.size() - pos, 65535));
+		const auto nlen = static_cast<std::uint16_t>(~len);
+		const bool last = pos + len == scanlines.size();
+		idat.insert(idat.end(), {
+			static_cast<std::uint8_t>(last ? 1 : 0),
+			static_cast<std::uint8_t>(len), static_cast<std::uint8_t>(len >> 8),
+			static_cast<std::uint8_t>(nlen), static_cast<std::uint8_t>(nlen >> 8),
+		});
+		idat.insert(idat.end(), scanlines.begin() + static_cast<std::ptrdiff_t>(pos),
+			scanlines.begin() + static_cast<std::ptrdiff_t>(pos + len));
+		pos += len;
+		if(last)
+			break;
+	}
+	put_u32_be(idat, adler32(scanlines.data(), scanlines.size()));
+
+	std::vector<std::uint8_t> header;
+	put_u32_be(header, static_cast<std::uint32_t>(width));
+	put_u32_be(header, static_cast<std::uint32_t>(height));
+	header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit RGBA, no interlace
+
+	static constexpr std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+	std::vector<std::uint8_t> file(signature, signature + 8);
+	file.reserve(idat.size() + 64);
+	put_chunk(file, "IHDR", header);
+	put_chunk(file, "IDAT", idat);
+	put_chunk(file, "IEND", {});
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	return static_cast<bool>(out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size())));
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Writes an RGBA8 image as PNG. The image data goes into stored (level 0)
+// deflate blocks: files are as big as raw pixels but writing costs little
+// more than the copy, which is what a capture worker needs. Recompress
+// offline if size matters.
+//
+// flip_rows writes the rows bottom-up, for pixels read back from GL.
+bool write_png_rgba8(const std::string& path, int width, int height, std::span<const std::uint8_t> pixels, bool flip_rows = false);
@@ -0,0 +1,55 @@
+#include "shader.hpp"
+
+#include <iostream>
+#include <string>
+
+GLuint compile_shader(GLenum type, const char* source) {
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+
+	GLint ok = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if(ok != GL_TRUE) {
+		GLint length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+		std::string log(static_cast<std::size_t>(length > 0 ? length : 1), '\0');
+		glGetShaderInfoLog(shader, length, nullptr, log.data());
+		std::cerr << "failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+			<< " shader:\n" << log.c_str() << "\n";
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+GLuint link_program(GLuint vertex, GLuint fragment) {
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	glLinkProgram(program);
+
+	GLint ok = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &ok);
+	if(ok != GL_TRUE) {
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::string log(static_cast<std::size_t>(length > 0 ? length : 1), '\0');
+		glGetProgramInfoLog(program, length, nullptr, log.data());
+		std::cerr << "failed to link program:\n" << log.c_str() << "\n";
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+GLuint create_program(const char* vertex_source, const char* fragment_source) {
+	GLuint vertex = compile_shader(GL_VERTEX_SHADER, vertex_source);
+	GLuint fragment = compile_shader(GL_FRAGMENT_SHADER, fragment_source);
+	GLuint program = 0;
+	if(vertex && fragment)
+		program = link_program(vertex, fragment);
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+	return program;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Compile/link helpers. Failures print the info log and return 0.
+GLuint compile_shader(GLenum type, const char* source);
+GLuint link_program(GLuint vertex, GLuint fragment);
+GLuint create_program(const char* vertex_source, const char* fragment_source);
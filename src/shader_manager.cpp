@@ -0,0 +1,403 @@
+#include "shader_manager.hpp"
+
+#include "hash.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+// GL_KHR_parallel_shader_compile, missing from the generated glad headers
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+static constexpr char binary_magic[4] = {'L', 'O', 'S', 'P'};
+static constexpr std::uint32_t binary_version = 1;
+
+struct program_binary_header {
+	char magic[4];
+	std::uint32_t version;
+	std::uint64_t key;
+	std::uint32_t format;
+	std::uint32_t size;
+};
+
+static bool has_extension(std::string_view name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for(GLint i = 0; i < count; ++i) {
+		const auto* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+		if(ext && name == ext)
+			return true;
+	}
+	return false;
+}
+
+static std::optional<std::string> read_file(const std::string& path) {
+	std::ifstream in(path, std::ios::binary);
+	if(!in)
+		return std::nullopt;
+	std::ostringstream text;
+	text << in.rdbuf();
+	return std::move(text).str();
+}
+
+// Puts the defines right after #version (which has to stay first) and resets
+// the line numbers so compile errors still point at the file.
+static std::string with_defines(const std::string& source, const std::vector<std::string>& defines) {
+	std::string header;
+	for(const auto& define : defines)
+		header += "#define " + define + "\n";
+
+	std::size_t insert_at = 0;
+	int next_line = 1;
+	if(source.starts_with("#version")) {
+		auto eol = source.find('\n');
+		insert_at = eol == std::string::npos ? source.size() : eol + 1;
+		next_line = 2;
+	}
+	std::string out = source.substr(0, insert_at);
+	if(insert_at == source.size() && !out.empty() && out.back() != '\n')
+		out += '\n';
+	out += header;
+	out += "#line " + std::to_string(next_line) + "\n";
+	out += source.substr(insert_at);
+	return out;
+}
+
+static std::string describe(const shader_variant_desc& desc) {
+	std::string name = desc.vertex_path + " + " + desc.fragment_path;
+	for(const auto& define : desc.defines)
+		name += " " + define;
+	return name;
+}
+
+static void print_shader_log(GLuint shader) {
+	GLint ok = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if(ok == GL_TRUE)
+		return;
+	GLint length = 0;
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+	std::string log(static_cast<std::size_t>(length > 0 ? length : 1), '\0');
+	glGetShaderInfoLog(shader, length, nullptr, log.data());
+	std::cerr << log.c_str() << "\n";
+}
+
+std::vector<std::vector<std::string>> define_permutations(const std::vector<std::string>& flags) {
+	std::vector<std::vector<std::string>> sets;
+	const std::size_t count = std::size_t{1} << flags.size();
+	sets.reserve(count);
+	for(std::size_t mask = 0; mask < count; ++mask) {
+		auto& set = sets.emplace_back();
+		for(std::size_t i = 0; i < flags.size(); ++i) {
+			if(mask & (std::size_t{1} << i))
+				set.push_back(flags[i]);
+		}
+	}
+	return sets;
+}
+
+shader_manager::shader_manager(shader_manager_options opts)
+	: options(std::move(opts)) {
+	if(!options.read_source)
+		options.read_source = read_file;
+
+	parallel = has_extension("GL_KHR_parallel_shader_compile");
+	if(parallel && options.load) {
+		auto max_threads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(options.load("glMaxShaderCompilerThreadsKHR"));
+		// let the driver pick how many threads to use
+		if(max_threads)
+			max_threads(0xffffffffu);
+	}
+
+	if(!options.cache_dir.empty()) {
+		if(!GLAD_GL_VERSION_4_1 && options.load && has_extension("GL_ARB_get_program_binary")) {
+			glad_glGetProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(options.load("glGetProgramBinary"));
+			glad_glProgramBinary = reinterpret_cast<PFNGLPROGRAMBINARYPROC>(options.load("glProgramBinary"));
+			glad_glProgramParameteri = reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(options.load("glProgramParameteri"));
+		}
+		GLint formats = 0;
+		if(glGetProgramBinary && glProgramBinary && glProgramParameteri)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		binaries = formats > 0;
+	}
+
+	for(auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+		if(const auto* str = reinterpret_cast<const char*>(glGetString(name)))
+			driver += str;
+		driver += '\n';
+	}
+
+	if(options.watch_interval.count() > 0)
+		watcher = std::jthread([this](std::stop_token stop) { watch(stop); });
+}
+
+shader_manager::~shader_manager() {
+	// stop the watcher before the state it shares goes away
+	if(watcher.joinable()) {
+		watcher.request_stop();
+		watcher.join();
+	}
+	for(auto& v : variants) {
+		glDeleteProgram(v.program);
+		glDeleteProgram(v.pending);
+		glDeleteShader(v.shaders[0]);
+		glDeleteShader(v.shaders[1]);
+	}
+}
+
+const std::string* shader_manager::source(const std::string& path) {
+	if(auto it = sources.find(path); it != sources.end())
+		return &it->second;
+	auto text = options.read_source(path);
+	if(!text) {
+		std::cerr << "failed to read shader " << path << "\n";
+		return nullptr;
+	}
+	if(options.watch_interval.count() > 0) {
+		std::error_code ec;
+		auto mtime = fs::last_write_time(path, ec);
+		std::lock_guard lock(mutex);
+		watched.try_emplace(path, mtime);
+	}
+	return &sources.emplace(path, std::move(*text)).first->second;
+}
+
+variant_id shader_manager::add(shader_variant_desc desc) {
+	auto& v = variants.emplace_back();
+	v.desc = std::move(desc);
+	submit(v);
+	return static_cast<variant_id>(variants.size() - 1);
+}
+
+void shader_manager::submit(variant& v) {
+	const auto* vertex = source(v.desc.vertex_path);
+	const auto* fragment = source(v.desc.fragment_path);
+	if(!vertex || !fragment) {
+		++counts.failed;
+		return;
+	}
+	auto vertex_text = with_defines(*vertex, v.desc.defines);
+	auto fragment_text = with_defines(*fragment, v.desc.defines);
+
+	v.key = fnv1a64(vertex_text);
+	v.key = fnv1a64(std::string_view("\0", 1), v.key);
+	v.key = fnv1a64(fragment_text, v.key);
+	v.key = fnv1a64(std::string_view("\0", 1), v.key);
+	v.key = fnv1a64(driver, v.key);
+
+	// a reload that is still compiling gets replaced by the newer sources
+	if(v.pending) {
+		glDeleteProgram(v.pending);
+		glDeleteShader(v.shaders[0]);
+		glDeleteShader(v.shaders[1]);
+		v.pending = 0;
+		v.shaders[0] = v.shaders[1] = 0;
+		--compiling;
+	}
+
+	if(binaries && load_binary(v))
+		return;
+
+	const char* texts[2] = {vertex_text.c_str(), fragment_text.c_str()};
+	const GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+	v.pending = glCreateProgram();
+	for(int i = 0; i < 2; ++i) {
+		v.shaders[i] = glCreateShader(types[i]);
+		glShaderSource(v.shaders[i], 1, &texts[i], nullptr);
+		glCompileShader(v.shaders[i]);
+		glAttachShader(v.pending, v.shaders[i]);
+	}
+	if(binaries)
+		glProgramParameteri(v.pending, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	// no status queries here, they would wait for the compile to finish
+	glLinkProgram(v.pending);
+	++compiling;
+}
+
+void shader_manager::finish(variant& v) {
+	GLint ok = GL_FALSE;
+	glGetProgramiv(v.pending, GL_LINK_STATUS, &ok);
+	if(ok != GL_TRUE) {
+		std::cerr << "failed to build " << describe(v.desc) << ":\n";
+		print_shader_log(v.shaders[0]);
+		print_shader_log(v.shaders[1]);
+		GLint length = 0;
+		glGetProgramiv(v.pending, GL_INFO_LOG_LENGTH, &length);
+		std::string log(static_cast<std::size_t>(length > 0 ? length : 1), '\0');
+		glGetProgramInfoLog(v.pending, length, nullptr, log.data());
+		std::cerr << log.c_str() << "\n";
+		glDeleteProgram(v.pending);
+		++counts.failed;
+	} else {
+		glDeleteProgram(v.program);
+		v.program = v.pending;
+		++counts.compiled;
+		if(binaries)
+			store_binary(v);
+	}
+	v.pending = 0;
+	for(auto& shader : v.shaders) {
+		glDeleteShader(shader);
+		shader = 0;
+	}
+	--compiling;
+}
+
+std::size_t shader_manager::poll() {
+	std::vector<std::pair<std::string, std::string>> changed;
+	if(watcher.joinable()) {
+		std::lock_guard lock(mutex);
+		changed.swap(reloaded);
+	}
+	for(auto& [path, text] : changed) {
+		sources[path] = std::move(text);
+		for(auto& v : variants) {
+			if(v.desc.vertex_path == path || v.desc.fragment_path == path) {
+				++counts.reloads;
+				submit(v);
+			}
+		}
+	}
+
+	for(auto& v : variants) {
+		if(!v.pending)
+			continue;
+		if(parallel) {
+			GLint done = GL_FALSE;
+			glGetProgramiv(v.pending, GL_COMPLETION_STATUS_KHR, &done);
+			if(done != GL_TRUE)
+				continue;
+		}
+		finish(v);
+	}
+	return compiling;
+}
+
+void clear_program_binaries(const std::string& cache_dir) {
+	std::error_code ec;
+	std::vector<fs::path> binaries;
+	for(const auto& entry : fs::directory_iterator(cache_dir, ec)) {
+		const auto name = entry.path().filename().string();
+		if(entry.is_regular_file() && (name.ends_with(".progbin") || name.ends_with(".progbin.tmp")))
+			binaries.push_back(entry.path());
+	}
+	for(const auto& path : binaries)
+		fs::remove(path, ec);
+}
+
+static std::string binary_path(const std::string& cache_dir, std::uint64_t key) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.progbin", static_cast<unsigned long long>(key));
+	return (fs::path(cache_dir) / name).string();
+}
+
+bool shader_manager::load_binary(variant& v) {
+	std::ifstream in(binary_path(options.cache_dir, v.key), std::ios::binary);
+	program_binary_header header;
+	if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+	if(std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0 || header.version != binary_version
+		|| header.key != v.key)
+		return false;
+	std::vector<char> data(header.size);
+	if(!in.read(data.data(), static_cast<std::streamsize>(data.size())))
+		return false;
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, header.format, data.data(), static_cast<GLsizei>(data.size()));
+	GLint ok = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &ok);
+	if(ok != GL_TRUE) {
+		// the driver may reject binaries from another build, compile instead
+		glDeleteProgram(program);
+		return false;
+	}
+
+	glDeleteProgram(v.program);
+	v.program = program;
+	++counts.cache_hits;
+	return true;
+}
+
+void shader_manager::store_binary(const variant& v) {
+	GLint length = 0;
+	glGetProgramiv(v.program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if(length <= 0)
+		return;
+	std::vector<char> data(static_cast<std::size_t>(length));
+	GLenum format = 0;
+	glGetProgramBinary(v.program, length, &length, &format, data.data());
+	if(length <= 0)
+		return;
+
+	program_binary_header header{};
+	std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+	header.version = binary_version;
+	header.key = v.key;
+	header.format = format;
+	header.size = static_cast<std::uint32_t>(length);
+
+	// write next to the target and rename so a crash never leaves half a file
+	std::error_code ec;
+	fs::create_directories(options.cache_dir, ec);
+	auto path = binary_path(options.cache_dir, v.key);
+	auto tmp = path + ".tmp";
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if(!out.write(data.data(), length)) {
+			std::cerr << "failed to write " << tmp << "\n";
+			return;
+		}
+	}
+	fs::rename(tmp, path, ec);
+	if(ec) {
+		std::cerr << "failed to move " << tmp << " into place: " << ec.message() << "\n";
+		return;
+	}
+	++counts.cache_writes;
+}
+
+void shader_manager::watch(std::stop_token stop) {
+	std::unique_lock lock(mutex);
+	for(;;) {
+		// only a stop request wakes this early
+		wake.wait_for(lock, stop, options.watch_interval, [] { return false; });
+		if(stop.stop_requested())
+			return;
+		auto files = watched;
+		lock.unlock();
+
+		std::vector<std::pair<std::string, fs::file_time_type>> changed;
+		for(const auto& [path, mtime] : files) {
+			std::error_code ec;
+			auto now = fs::last_write_time(path, ec);
+			if(!ec && now != mtime)
+				changed.emplace_back(path, now);
+		}
+
+		// read outside the lock, the GL thread only waits for the swap
+		std::vector<std::pair<std::string, std::string>> texts;
+		for(const auto& [path, mtime] : changed) {
+			if(auto text = options.read_source(path))
+				texts.emplace_back(path, std::move(*text));
+		}
+
+		lock.lock();
+		for(const auto& [path, mtime] : changed)
+			watched[path] = mtime;
+		for(auto& entry : texts)
+			reloaded.push_back(std::move(entry));
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// One program built from a vertex and a fragment source with a set of
+// defines ("NAME" or "NAME VALUE") inserted after the #version line.
+struct shader_variant_desc {
+	std::string vertex_path;
+	std::string fragment_path;
+	std::vector<std::string> defines;
+};
+
+using variant_id = std::uint32_t;
+
+// Every subset of flags, as define lists: 2^n variants.
+std::vector<std::vector<std::string>> define_permutations(const std::vector<std::string>& flags);
+
+// Deletes the program binaries (and leftover temp files) shader_manager
+// wrote to cache_dir, leaving anything else in it alone.
+void clear_program_binaries(const std::string& cache_dir);
+
+struct shader_manager_options {
+	// linked program binaries are stored here, empty disables them
+	std::string cache_dir = "shader-cache";
+	// resolves glMaxShaderCompilerThreadsKHR and, on contexts older than 4.1,
+	// the ARB_get_program_binary entry points; glad is generated without them
+	GLADloadproc load = nullptr;
+	// how often the watcher thread checks sources for changes, 0 disables it
+	std::chrono::milliseconds watch_interval{0};
+	// reads a source by path, plain files when empty. Also called from the
+	// watcher thread.
+	std::function<std::optional<std::string>(const std::string&)> read_source;
+};
+
+struct shader_stats {
+	std::size_t compiled = 0;
+	std::size_t cache_hits = 0;
+	std::size_t cache_writes = 0;
+	std::size_t failed = 0;
+	std::size_t reloads = 0;
+};
+
+// Owns shader program variants. add() starts the compile right away and
+// poll() picks up finished links, so with GL_KHR_parallel_shader_compile the
+// driver compiles all variants on its own threads while frames keep going.
+//
+// Linked programs are saved with glGetProgramBinary, keyed by a hash of the
+// preprocessed sources and the GL vendor/renderer/version strings, so a driver
+// update or an edited source never picks up a stale binary.
+//
+// With a watch interval, a background thread rereads changed sources and the
+// next poll() recompiles only the variants using them. A variant keeps its
+// previous program until the new one links.
+class shader_manager {
+public:
+	explicit shader_manager(shader_manager_options options = {});
+	~shader_manager();
+
+	shader_manager(const shader_manager&) = delete;
+	shader_manager& operator=(const shader_manager&) = delete;
+
+	variant_id add(shader_variant_desc desc);
+
+	// Finishes completed programs and starts reloads; returns how many
+	// programs are still compiling. GL thread only, like everything else here.
+	std::size_t poll();
+	bool ready() const { return compiling == 0; }
+
+	// 0 until the variant first links
+	GLuint program(variant_id id) const { return variants[id].program; }
+
+	const shader_stats& stats() const { return counts; }
+	bool parallel_compile() const { return parallel; }
+	bool program_binaries() const { return binaries; }
+
+private:
+	struct variant {
+		shader_variant_desc desc;
+		GLuint program = 0;
+		GLuint pending = 0;
+		GLuint shaders[2] = {};
+		std::uint64_t key = 0;
+	};
+
+	const std::string* source(const std::string& path);
+	void submit(variant& v);
+	void finish(variant& v);
+	bool load_binary(variant& v);
+	void store_binary(const variant& v);
+	void watch(std::stop_token stop);
+
+	shader_manager_options options;
+	bool parallel = false;
+	bool binaries = false;
+	std::string driver;
+
+	std::vector<variant> variants;
+	std::unordered_map<std::string, std::string> sources;
+	std::size_t compiling = 0;
+	shader_stats counts;
+
+	// shared with the watcher thread
+	std::mutex mutex;
+	std::unordered_map<std::string, std::filesystem::file_time_type> watched;
+	std::vector<std::pair<std::string, std::string>> reloaded;
+	std::condition_variable_any wake;
+	std::jthread watcher;
+};
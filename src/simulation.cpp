@@ -0,0 +1,103 @@
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+simulation::simulation(double tick_rate)
+	: dt(std::chrono::duration_cast<sim_clock::duration>(std::chrono::duration<double>(1.0 / tick_rate))) {
+	// thread is declared last, everything it touches is constructed by now
+	thread = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+simulation::~simulation() {
+	thread.request_stop();
+	thread.join();
+}
+
+bool simulation::push_input(const input_event& event) {
+	if(inputs.try_push(event))
+		return true;
+	dropped.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+const sim_snapshot& simulation::latest() {
+	snapshots.update();
+	return snapshots.read_buffer();
+}
+
+world_state simulation::interpolate(const sim_snapshot& snap, sim_clock::time_point now) const {
+	// rendering one tick behind the simulation, so a frame between two ticks
+	// blends the last two states instead of extrapolating
+	auto alpha = std::chrono::duration<float>(now - snap.tick_time) / std::chrono::duration<float>(dt);
+	alpha = std::clamp(alpha, 0.0f, 1.0f);
+
+	world_state state = snap.current;
+	for(int i = 0; i < 3; ++i)
+		state.color[i] = snap.previous.color[i] + (snap.current.color[i] - snap.previous.color[i]) * alpha;
+	return state;
+}
+
+void simulation::apply(world_state& state, const input_event& event) {
+	switch(event.action) {
+	case input_action::toggle_animation:
+		state.animating = !state.animating;
+		break;
+	case input_action::resize:
+		state.width = event.width;
+		state.height = event.height;
+		break;
+	}
+}
+
+void simulation::step(world_state& state) {
+	if(!state.animating)
+		return;
+	constexpr float two_pi = 6.28318530718f;
+	// slow drift around the default clear color
+	state.phase = std::fmod(state.phase + std::chrono::duration<float>(dt).count() * 0.25f, 1.0f);
+	const float angle = state.phase * two_pi;
+	state.color[0] = 0.2f + 0.15f * std::sin(angle);
+	state.color[1] = 0.3f + 0.15f * std::sin(angle + two_pi / 3.0f);
+	state.color[2] = 0.3f + 0.15f * std::sin(angle + 2.0f * two_pi / 3.0f);
+}
+
+void simulation::run(std::stop_token stop) {
+	world_state state;
+	std::uint64_t tick = 0;
+	std::uint64_t input_seq = 0;
+	sim_clock::time_point input_time;
+	auto next = sim_clock::now();
+
+	while(!stop.stop_requested()) {
+		auto previous = state;
+
+		bool had_input = false;
+		while(auto event = inputs.try_pop()) {
+			if(!had_input) {
+				input_time = event->time;
+				had_input = true;
+				++input_seq;
+			}
+			apply(state, *event);
+		}
+		step(state);
+		++tick;
+
+		auto& snap = snapshots.write_buffer();
+		snap.previous = previous;
+		snap.current = state;
+		snap.tick_time = next;
+		snap.tick = tick;
+		snap.input_seq = input_seq;
+		snap.input_time = input_time;
+		snapshots.publish();
+		tick_count.fetch_add(1, std::memory_order_relaxed);
+
+		next += dt;
+		auto now = sim_clock::now();
+		if(now - next > 8 * dt)
+			next = now; // fell far behind (debugger, suspend), don't try to catch up
+		std::this_thread::sleep_until(next);
+	}
+}
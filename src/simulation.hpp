@@ -0,0 +1,85 @@
+#pragma once
+
+#include "spsc_queue.hpp"
+#include "triple_buffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using sim_clock = std::chrono::steady_clock;
+
+enum class input_action : std::uint8_t {
+	toggle_animation,
+	resize,
+};
+
+// Forwarded from the window callbacks; time is when the callback ran so the
+// render thread can tell how long it took until the result was on screen.
+struct input_event {
+	input_action action = input_action::toggle_animation;
+	int width = 0;
+	int height = 0;
+	sim_clock::time_point time;
+};
+
+struct world_state {
+	float color[3] = {0.2f, 0.3f, 0.3f};
+	float phase = 0.0f;
+	bool animating = false;
+	int width = 0;
+	int height = 0;
+};
+
+// What the simulation thread publishes every tick. Holds the last two states
+// so the renderer can interpolate between them.
+struct sim_snapshot {
+	world_state previous;
+	world_state current;
+	sim_clock::time_point tick_time;
+	std::uint64_t tick = 0;
+	// bumped whenever a tick consumed input; input_time is that input's
+	// timestamp (the oldest one if there were several)
+	std::uint64_t input_seq = 0;
+	sim_clock::time_point input_time;
+};
+
+// Runs the world update at a fixed rate on its own thread.
+//
+// Input goes in through push_input() from the thread that owns the window;
+// snapshots come out through latest() on the render thread. Both directions
+// are lock-free and neither thread ever waits on the other.
+class simulation {
+public:
+	explicit simulation(double tick_rate = 120.0);
+	~simulation();
+
+	simulation(const simulation&) = delete;
+	simulation& operator=(const simulation&) = delete;
+
+	// Producer side of the input queue. Returns false if the queue is full.
+	bool push_input(const input_event& event);
+
+	// Render thread only. Picks up the newest published snapshot, if any.
+	const sim_snapshot& latest();
+
+	// Blends the snapshot's two states for a frame presented at `now`.
+	world_state interpolate(const sim_snapshot& snap, sim_clock::time_point now) const;
+
+	std::uint64_t ticks() const { return tick_count.load(std::memory_order_relaxed); }
+	std::uint64_t dropped_inputs() const { return dropped.load(std::memory_order_relaxed); }
+	sim_clock::duration tick_duration() const { return dt; }
+
+private:
+	void run(std::stop_token stop);
+	void apply(world_state& state, const input_event& event);
+	void step(world_state& state);
+
+	const sim_clock::duration dt;
+	spsc_queue<input_event, 256> inputs;
+	triple_buffer<sim_snapshot> snapshots;
+	std::atomic<std::uint64_t> tick_count{0};
+	std::atomic<std::uint64_t> dropped{0};
+	std::jthread thread;
+};
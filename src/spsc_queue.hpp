@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// Bounded single-producer/single-consumer ring. Both ends are wait-free: a
+// push or pop is a couple of loads and one release store, and a full queue
+// rejects the push instead of waiting. Capacity must be a power of two.
+template<typename T, std::size_t Capacity>
+class spsc_queue {
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+	bool try_push(const T& value) {
+		const auto tail = tail_.load(std::memory_order_relaxed);
+		if(tail - head_cache == Capacity) {
+			head_cache = head_.load(std::memory_order_acquire);
+			if(tail - head_cache == Capacity)
+				return false;
+		}
+		slots[tail & (Capacity - 1)] = value;
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	std::optional<T> try_pop() {
+		const auto head = head_.load(std::memory_order_relaxed);
+		if(head == tail_cache) {
+			tail_cache = tail_.load(std::memory_order_acquire);
+			if(head == tail_cache)
+				return std::nullopt;
+		}
+		std::optional<T> value(slots[head & (Capacity - 1)]);
+		head_.store(head + 1, std::memory_order_release);
+		return value;
+	}
+
+private:
+	static constexpr std::size_t cache_line = 64;
+
+	std::array<T, Capacity> slots{};
+	// producer side
+	alignas(cache_line) std::atomic<std::size_t> tail_{0};
+	std::size_t head_cache = 0;
+	// consumer side
+	alignas(cache_line) std::atomic<std::size_t> head_{0};
+	std::size_t tail_cache = 0;
+};
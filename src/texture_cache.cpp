@@ -0,0 +1,232 @@
+#include "texture_cache.hpp"
+
+#include "hash.hpp"
+#include "image_decode.hpp"
+#include "image_ops.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static constexpr char cache_magic[4] = {'L', 'O', 'T', 'C'};
+static constexpr std::uint32_t cache_version = 1;
+static constexpr std::uint64_t payload_alignment = 64;
+
+struct source_info {
+	std::int64_t mtime = 0;
+	std::uint64_t size = 0;
+};
+
+static std::optional<source_info> stat_source(const std::string& source) {
+	std::error_code ec;
+	auto mtime = fs::last_write_time(source, ec);
+	if(ec)
+		return std::nullopt;
+	auto size = fs::file_size(source, ec);
+	if(ec)
+		return std::nullopt;
+	return source_info{static_cast<std::int64_t>(mtime.time_since_epoch().count()), size};
+}
+
+static std::uint64_t align_up(std::uint64_t value, std::uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Validates the header and level table against the mapped size.
+static const texture_cache_header* parse_header(const mapped_file& file) {
+	if(file.size() < sizeof(texture_cache_header))
+		return nullptr;
+	const auto* header = reinterpret_cast<const texture_cache_header*>(file.data());
+	if(std::memcmp(header->magic, cache_magic, sizeof(cache_magic)) != 0 || header->version != cache_version)
+		return nullptr;
+	if(header->levels == 0 || header->levels > 32)
+		return nullptr;
+	if(file.size() < sizeof(texture_cache_header) + header->levels * sizeof(texture_cache_level))
+		return nullptr;
+
+	const auto* levels = reinterpret_cast<const texture_cache_level*>(header + 1);
+	for(std::uint32_t i = 0; i < header->levels; ++i) {
+		const auto& level = levels[i];
+		if(level.offset > file.size() || level.size > file.size() - level.offset)
+			return nullptr;
+		if(level.size != std::uint64_t{level.width} * level.height * 4)
+			return nullptr;
+	}
+	return header;
+}
+
+std::string texture_cache_path(const std::string& cache_dir, const std::string& source) {
+	std::error_code ec;
+	auto absolute = fs::weakly_canonical(source, ec);
+	auto key = fnv1a64(ec ? source : absolute.generic_string());
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.texcache", static_cast<unsigned long long>(key));
+	return (fs::path(cache_dir) / name).string();
+}
+
+static std::optional<texture_cache_header> read_header(const std::string& cache_file) {
+	std::ifstream in(cache_file, std::ios::binary);
+	texture_cache_header header;
+	if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return std::nullopt;
+	if(std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 || header.version != cache_version)
+		return std::nullopt;
+	return header;
+}
+
+texture_cache_status check_texture_cache(const std::string& source, const std::string& cache_file) {
+	auto header = read_header(cache_file);
+	if(!header)
+		return texture_cache_status::missing;
+	auto info = stat_source(source);
+	if(!info)
+		return texture_cache_status::fresh;
+	if(info->mtime == header->source_mtime && info->size == header->source_size)
+		return texture_cache_status::fresh;
+	return texture_cache_status::stale;
+}
+
+static bool move_into_place(const std::string& tmp, const std::string& cache_file) {
+	std::error_code ec;
+	fs::rename(tmp, cache_file, ec);
+	if(ec) {
+		std::cerr << "failed to move " << tmp << " into place: " << ec.message() << "\n";
+		return false;
+	}
+	return true;
+}
+
+bool write_texture_cache(const std::string& source, const std::string& cache_file) {
+	auto info = stat_source(source);
+	if(!info) {
+		std::cerr << "failed to stat " << source << "\n";
+		return false;
+	}
+
+	std::vector<unsigned char> encoded(info->size);
+	{
+		std::ifstream in(source, std::ios::binary);
+		if(!in.read(reinterpret_cast<char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()))) {
+			std::cerr << "failed to read " << source << "\n";
+			return false;
+		}
+	}
+	auto hash = fnv1a64(std::as_bytes(std::span(encoded)));
+
+	// touched but unchanged, only the recorded mtime needs updating
+	if(auto existing = read_header(cache_file); existing && existing->source_hash == hash
+		&& existing->source_size == info->size) {
+		// patch a copy and rename it like a full rewrite, so a failure midway
+		// leaves the old, still valid file behind
+		existing->source_mtime = info->mtime;
+		auto tmp = cache_file + ".tmp";
+		std::error_code ec;
+		fs::copy_file(cache_file, tmp, fs::copy_options::overwrite_existing, ec);
+		if(ec) {
+			std::cerr << "failed to copy " << cache_file << ": " << ec.message() << "\n";
+			return false;
+		}
+		{
+			std::fstream out(tmp, std::ios::binary | std::ios::in | std::ios::out);
+			if(!out.write(reinterpret_cast<const char*>(&*existing), sizeof(*existing))) {
+				std::cerr << "failed to write " << tmp << "\n";
+				return false;
+			}
+		}
+		return move_into_place(tmp, cache_file);
+	}
+
+	auto image = decode_rgba8(std::as_bytes(std::span(encoded)));
+	if(!image.pixels) {
+		std::cerr << "failed to decode " << source << ": " << image.error << "\n";
+		return false;
+	}
+	encoded = {};
+	const int width = image.width;
+	const int height = image.height;
+
+	const int level_count = mip_level_count(width, height);
+	std::vector<texture_cache_level> levels(static_cast<std::size_t>(level_count));
+	auto offset = align_up(sizeof(texture_cache_header) + levels.size() * sizeof(texture_cache_level), payload_alignment);
+	for(int i = 0, w = width, h = height; i < level_count; ++i) {
+		auto& level = levels[static_cast<std::size_t>(i)];
+		level.width = static_cast<std::uint32_t>(w);
+		level.height = static_cast<std::uint32_t>(h);
+		level.size = std::uint64_t{level.width} * level.height * 4;
+		level.offset = offset;
+		offset = align_up(offset + level.size, payload_alignment);
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+	}
+
+	std::vector<std::uint8_t> payload(offset);
+	std::memcpy(payload.data() + levels[0].offset, image.pixels.get(), levels[0].size);
+	image.pixels.reset();
+	for(std::size_t i = 1; i < levels.size(); ++i) {
+		const auto& prev = levels[i - 1];
+		downsample_box_rgba8(payload.data() + prev.offset, static_cast<int>(prev.width), static_cast<int>(prev.height),
+			payload.data() + levels[i].offset);
+	}
+
+	texture_cache_header header{};
+	std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+	header.version = cache_version;
+	header.source_hash = hash;
+	header.source_mtime = info->mtime;
+	header.source_size = info->size;
+	header.width = static_cast<std::uint32_t>(width);
+	header.height = static_cast<std::uint32_t>(height);
+	header.levels = static_cast<std::uint32_t>(level_count);
+	std::memcpy(payload.data(), &header, sizeof(header));
+	std::memcpy(payload.data() + sizeof(header), levels.data(), levels.size() * sizeof(texture_cache_level));
+
+	// write next to the target and rename so readers never map a partial file
+	std::error_code ec;
+	fs::create_directories(fs::path(cache_file).parent_path(), ec);
+	auto tmp = cache_file + ".tmp";
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		if(!out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()))) {
+			std::cerr << "failed to write " << tmp << "\n";
+			return false;
+		}
+	}
+	return move_into_place(tmp, cache_file);
+}
+
+GLuint load_cached_texture(const std::string& cache_file, const std::string& source) {
+	mapped_file file(cache_file);
+	if(!file.is_open())
+		return 0;
+	const auto* header = parse_header(file);
+	if(!header)
+		return 0;
+	if(auto info = stat_source(source); info && (info->mtime != header->source_mtime || info->size != header->source_size))
+		return 0;
+
+	const auto* levels = reinterpret_cast<const texture_cache_level*>(header + 1);
+	GLuint tex = 0;
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	for(std::uint32_t i = 0; i < header->levels; ++i) {
+		const auto& level = levels[i];
+		glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), GL_RGBA8, static_cast<GLsizei>(level.width),
+			static_cast<GLsizei>(level.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, file.data() + level.offset);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(header->levels - 1));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return tex;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+
+// Decoded textures with their full mip chain, stored so that startup can map
+// the file and hand each level straight to glTexImage2D.
+//
+// File layout (little endian):
+//   texture_cache_header
+//   texture_cache_level[levels]
+//   RGBA8 payload for each level, every level starting on a 64 byte boundary
+//
+// A cache file belongs to one source image. It is considered fresh while the
+// source's size and modification time match the header; the content hash is
+// used to skip rebuilding sources that were touched but not changed.
+
+struct texture_cache_header {
+	char magic[4];
+	std::uint32_t version;
+	std::uint64_t source_hash;
+	std::int64_t source_mtime;
+	std::uint64_t source_size;
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint32_t levels;
+	std::uint32_t reserved;
+};
+
+struct texture_cache_level {
+	std::uint64_t offset;
+	std::uint64_t size;
+	std::uint32_t width;
+	std::uint32_t height;
+};
+
+enum class texture_cache_status { fresh, stale, missing };
+
+// <cache_dir>/<hash of the source path>.texcache
+std::string texture_cache_path(const std::string& cache_dir, const std::string& source);
+
+texture_cache_status check_texture_cache(const std::string& source, const std::string& cache_file);
+
+// Decodes source, builds the mip chain on the CPU and writes cache_file.
+bool write_texture_cache(const std::string& source, const std::string& cache_file);
+
+// Creates a texture from a fresh cache file, 0 if it's missing, stale or
+// malformed. If the source no longer exists the cache is used as is.
+GLuint load_cached_texture(const std::string& cache_file, const std::string& source);
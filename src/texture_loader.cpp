@@ -0,0 +1,215 @@
+#include "texture_loader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+static std::vector<unsigned char> read_file(const std::string& path) {
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if(!in)
+		return {};
+	std::vector<unsigned char> data(static_cast<std::size_t>(in.tellg()));
+	in.seekg(0);
+	in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	if(!in)
+		return {};
+	return data;
+}
+
+texture_loader::texture_loader(thread_pool& pool, texture_loader_options opts)
+	: pool(pool), opts(opts), state(std::make_shared<shared_state>(opts.queue_capacity)) {
+	pbos.resize(std::max<std::size_t>(opts.pbo_count, 1));
+	for(auto& pbo : pbos) {
+		glGenBuffers(1, &pbo.buffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(opts.pbo_size), nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+texture_loader::~texture_loader() {
+	state->cancelled = true;
+	// jobs that haven't started bail out on cancelled, wait for the rest
+	for(auto n = state->running.load(); n != 0; n = state->running.load())
+		state->running.wait(n);
+	for(auto& pbo : pbos) {
+		if(pbo.fence)
+			glDeleteSync(pbo.fence);
+		glDeleteBuffers(1, &pbo.buffer);
+	}
+	for(auto& e : entries)
+		glDeleteTextures(1, &e.id);
+}
+
+texture_handle texture_loader::load(std::string path) {
+	auto handle = static_cast<texture_handle>(entries.size());
+	auto& e = entries.emplace_back();
+	glGenTextures(1, &e.id);
+	e.path = std::move(path);
+	++stats.requested;
+
+	pool.submit([state = state, pack = opts.pack, handle, path = e.path] { decode(state, pack, handle, path); });
+	return handle;
+}
+
+void texture_loader::decode(const std::shared_ptr<shared_state>& state, const asset_pack* pack, texture_handle handle, const std::string& path) {
+	// counted before checking cancelled so the destructor either sees this
+	// job running or the job sees the cancel
+	++state->running;
+	struct running_guard {
+		std::atomic<std::size_t>& running;
+		~running_guard() {
+			--running;
+			running.notify_all();
+		}
+	} guard{state->running};
+	if(state->cancelled)
+		return;
+
+	decoded_image image;
+	image.handle = handle;
+	std::vector<unsigned char> data;
+	asset_bytes asset;
+	std::span<const std::byte> bytes;
+	if(pack) {
+		if(pack->load(path, asset))
+			bytes = asset.bytes();
+	}
+	else {
+		data = read_file(path);
+		bytes = std::as_bytes(std::span(data));
+	}
+	if(bytes.empty())
+		image.error = pack ? "not in the asset pack" : "failed to read file";
+	else {
+		auto decoded = decode_rgba8(bytes);
+		image.width = decoded.width;
+		image.height = decoded.height;
+		image.pixels = std::move(decoded.pixels);
+		if(!image.pixels)
+			image.error = decoded.error;
+	}
+
+	// Space only frees up when update() drains the queue, once a frame, so
+	// poll with a short sleep rather than yielding in a busy loop. A
+	// millisecond is well under a frame and keeps cancellation prompt without
+	// update() having to notify anyone.
+	while(!state->decoded.try_push(std::move(image))) {
+		if(state->cancelled)
+			return;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+std::size_t texture_loader::update() {
+	while(auto image = state->decoded.try_pop())
+		receive(std::move(*image));
+
+	std::size_t uploaded = 0;
+	while(!uploads.empty()) {
+		auto& up = uploads.front();
+		auto bytes = upload_rows(up, uploaded);
+		if(bytes == 0)
+			break; // out of budget or staging buffers for this frame
+		uploaded += bytes;
+
+		if(up.next_row == up.image.height) {
+			auto& e = entries[up.image.handle];
+			glBindTexture(GL_TEXTURE_2D, e.id);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			e.state = texture_state::ready;
+			++stats.ready;
+			uploads.pop_front();
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	stats.bytes_uploaded += uploaded;
+	return uploaded;
+}
+
+void texture_loader::receive(decoded_image image) {
+	auto& e = entries[image.handle];
+	if(!image.pixels) {
+		std::cerr << "failed to load " << e.path << ": " << image.error << "\n";
+		e.state = texture_state::failed;
+		++stats.failed;
+		return;
+	}
+
+	e.state = texture_state::uploading;
+	uploads.push_back({std::move(image), 0, false});
+}
+
+void texture_loader::allocate(const decoded_image& image) {
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+std::size_t texture_loader::upload_rows(pending_upload& up, std::size_t uploaded) {
+	const auto row_bytes = static_cast<std::size_t>(up.image.width) * 4;
+	const auto rows_left = static_cast<std::size_t>(up.image.height - up.next_row);
+	const auto* src = up.image.pixels.get() + static_cast<std::size_t>(up.next_row) * row_bytes;
+	glBindTexture(GL_TEXTURE_2D, entries[up.image.handle].id);
+
+	if(!up.allocated) {
+		// allocated when its first rows go up rather than when decoding
+		// finishes, a burst of decoded images would otherwise all allocate
+		// in the same frame
+		allocate(up.image);
+		up.allocated = true;
+	}
+
+	if(row_bytes > opts.pbo_size) {
+		// doesn't fit a staging buffer, upload straight from client memory
+		// in a frame of its own
+		if(uploaded != 0)
+			return 0;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, up.next_row, up.image.width, static_cast<GLsizei>(rows_left),
+			GL_RGBA, GL_UNSIGNED_BYTE, src);
+		up.next_row = up.image.height;
+		return rows_left * row_bytes;
+	}
+
+	const auto budget = opts.upload_budget - std::min(opts.upload_budget, uploaded);
+	auto rows = std::min({rows_left, opts.pbo_size / row_bytes, budget / row_bytes});
+	if(rows == 0) {
+		if(uploaded != 0)
+			return 0;
+		rows = 1;
+	}
+
+	auto& pbo = pbos[next_pbo];
+	if(pbo.fence) {
+		// still being read by an earlier upload, try again next frame
+		if(glClientWaitSync(pbo.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			return 0;
+		glDeleteSync(pbo.fence);
+		pbo.fence = nullptr;
+	}
+
+	const auto bytes = rows * row_bytes;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+	auto* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if(!dst)
+		return 0;
+	std::memcpy(dst, src, bytes);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, up.next_row, up.image.width, static_cast<GLsizei>(rows),
+		GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	pbo.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	next_pbo = (next_pbo + 1) % pbos.size();
+
+	up.next_row += static_cast<int>(rows);
+	return bytes;
+}
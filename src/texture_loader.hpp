@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "asset_pack.hpp"
+#include "image_decode.hpp"
+#include "mpmc_queue.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct texture_loader_options {
+	std::size_t pbo_count = 4;
+	std::size_t pbo_size = 4u << 20;
+	// bytes copied into pixel buffers per update(); one row is always let
+	// through so a single huge texture can't stall loading forever
+	std::size_t upload_budget = 8u << 20;
+	// decoded images waiting for the GL thread; workers back off when full
+	std::size_t queue_capacity = 64;
+	// when set, load() paths are asset names in this pack instead of files;
+	// compressed entries are inflated on the decode workers. Has to outlive
+	// the loader, whose destructor waits for decodes still using it.
+	const asset_pack* pack = nullptr;
+};
+
+struct texture_loader_stats {
+	std::size_t requested = 0;
+	std::size_t ready = 0;
+	std::size_t failed = 0;
+	std::size_t bytes_uploaded = 0;
+};
+
+using texture_handle = std::uint32_t;
+
+// Decodes images with stb_image on a thread pool and streams the pixels into
+// GL textures through a ring of pixel unpack buffers, limited to a fixed
+// number of bytes per frame.
+//
+// Everything except the decode runs on the GL thread: load() creates the
+// texture name right away so it can be bound before the pixels arrive, and
+// update() has to be called once per frame to upload what's been decoded.
+class texture_loader {
+public:
+	explicit texture_loader(thread_pool& pool, texture_loader_options opts = {});
+	~texture_loader();
+
+	texture_loader(const texture_loader&) = delete;
+	texture_loader& operator=(const texture_loader&) = delete;
+
+	texture_handle load(std::string path);
+
+	// Returns the number of bytes uploaded this call.
+	std::size_t update();
+
+	GLuint texture(texture_handle handle) const { return entries[handle].id; }
+	bool ready(texture_handle handle) const { return entries[handle].state == texture_state::ready; }
+	bool idle() const { return stats.ready + stats.failed == stats.requested; }
+	const texture_loader_stats& get_stats() const { return stats; }
+
+private:
+	struct decoded_image {
+		texture_handle handle = 0;
+		int width = 0;
+		int height = 0;
+		std::unique_ptr<std::uint8_t, rgba8_image::deleter> pixels{nullptr, nullptr};
+		std::string error;
+	};
+
+	// outlives the loader while decode jobs are still queued on the pool
+	struct shared_state {
+		explicit shared_state(std::size_t capacity) : decoded(capacity) {}
+		mpmc_queue<decoded_image> decoded;
+		std::atomic<bool> cancelled{false};
+		// decode jobs past their cancelled check; the destructor waits for
+		// them since they may still be reading from opts.pack
+		std::atomic<std::size_t> running{0};
+	};
+
+	enum class texture_state { decoding, uploading, ready, failed };
+
+	struct entry {
+		GLuint id = 0;
+		texture_state state = texture_state::decoding;
+		std::string path;
+	};
+
+	struct pending_upload {
+		decoded_image image;
+		int next_row = 0;
+		bool allocated = false;
+	};
+
+	struct pbo_slot {
+		GLuint buffer = 0;
+		GLsync fence = nullptr;
+	};
+
+	static void decode(const std::shared_ptr<shared_state>& state, const asset_pack* pack, texture_handle handle, const std::string& path);
+
+	void receive(decoded_image image);
+	void allocate(const decoded_image& image);
+	// Returns the bytes uploaded, 0 when nothing more fits this frame.
+	std::size_t upload_rows(pending_upload& up, std::size_t uploaded);
+
+	thread_pool& pool;
+	texture_loader_options opts;
+	std::shared_ptr<shared_state> state;
+	std::vector<entry> entries;
+	std::deque<pending_upload> uploads;
+	std::vector<pbo_slot> pbos;
+	std::size_t next_pbo = 0;
+	texture_loader_stats stats;
+};
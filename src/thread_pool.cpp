@@ -0,0 +1,42 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+thread_pool::thread_pool(unsigned workers) {
+	if(workers == 0)
+		workers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	threads.reserve(workers);
+	for(unsigned i = 0; i < workers; ++i)
+		threads.emplace_back([this](std::stop_token stop) { run(stop); });
+}
+
+thread_pool::~thread_pool() {
+	for(auto& t : threads)
+		t.request_stop();
+	wake.notify_all();
+	// jthread joins on destruction. wait() returns the predicate even after a
+	// stop request, so workers keep draining the queue: every submitted job
+	// runs before the destructor returns
+}
+
+void thread_pool::submit(std::function<void()> job) {
+	{
+		std::lock_guard lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	wake.notify_one();
+}
+
+void thread_pool::run(std::stop_token stop) {
+	for(;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock lock(mutex);
+			if(!wake.wait(lock, stop, [this] { return !jobs.empty(); }))
+				return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling jobs from a shared FIFO.
+class thread_pool {
+public:
+	// 0 picks one worker per hardware thread, leaving one for the GL thread.
+	explicit thread_pool(unsigned workers = 0);
+	~thread_pool();
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	void submit(std::function<void()> job);
+	unsigned size() const { return static_cast<unsigned>(threads.size()); }
+
+private:
+	void run(std::stop_token stop);
+
+	std::mutex mutex;
+	std::condition_variable_any wake;
+	std::deque<std::function<void()>> jobs;
+	std::vector<std::jthread> threads;
+};
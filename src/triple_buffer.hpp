@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free triple buffer for handing the latest value from one writer thread
+// to one reader thread. The writer fills write_buffer() and publishes it; the
+// reader calls update() and then reads read_buffer(), which stays untouched
+// until its next update(). Neither side ever waits, and values the reader
+// didn't get to in time are simply replaced.
+template<typename T>
+class triple_buffer {
+public:
+	T& write_buffer() { return buffers[back]; }
+
+	void publish() {
+		back = middle.exchange(static_cast<std::uint8_t>(back | dirty), std::memory_order_acq_rel) & index_mask;
+	}
+
+	// Returns true if a newer value was published since the last call.
+	bool update() {
+		if(!(middle.load(std::memory_order_relaxed) & dirty))
+			return false;
+		front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+		return true;
+	}
+
+	const T& read_buffer() const { return buffers[front]; }
+
+private:
+	static constexpr std::uint8_t index_mask = 0x3;
+	static constexpr std::uint8_t dirty = 0x4;
+	static constexpr std::size_t cache_line = 64;
+
+	std::array<T, 3> buffers{};
+	alignas(cache_line) std::atomic<std::uint8_t> middle{1};
+	alignas(cache_line) std::uint8_t back = 0; // writer only
+	alignas(cache_line) std::uint8_t front = 2; // reader only
+};
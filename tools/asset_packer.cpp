@@ -0,0 +1,54 @@
+#include "asset_pack.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Packs every file under a directory into one asset pack. Asset names are
+// the paths relative to that directory.
+int main(int argc, char* argv[]) {
+	bool compress = false;
+	std::vector<std::string> args;
+	for(int i = 1; i < argc; ++i) {
+		if(std::string_view(argv[i]) == "--lz4")
+			compress = true;
+		else
+			args.emplace_back(argv[i]);
+	}
+	if(args.size() != 2) {
+		std::cerr << "usage: " << argv[0] << " [--lz4] <output pack> <directory>\n";
+		return EXIT_FAILURE;
+	}
+
+	const fs::path root = args[1];
+	std::vector<asset_pack_source> sources;
+	std::error_code ec;
+	for(const auto& entry : fs::recursive_directory_iterator(root, ec)) {
+		if(entry.is_regular_file())
+			sources.push_back({entry.path().lexically_relative(root).generic_string(), entry.path().string()});
+	}
+	if(ec) {
+		std::cerr << "failed to list " << root.string() << ": " << ec.message() << "\n";
+		return EXIT_FAILURE;
+	}
+	std::sort(sources.begin(), sources.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+
+	if(!write_asset_pack(args[0], sources, compress))
+		return EXIT_FAILURE;
+
+	asset_pack pack(args[0]);
+	std::size_t compressed = 0;
+	for(const auto& source : sources) {
+		if(const auto* entry = pack.find(source.name); entry && entry->compression != asset_compression::none)
+			++compressed;
+	}
+	std::cout << sources.size() << " assets, " << compressed << " compressed, "
+		<< fs::file_size(args[0], ec) << " bytes\n";
+	return EXIT_SUCCESS;
+}
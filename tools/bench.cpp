@@ -0,0 +1,267 @@
+#include <glad/glad.h>
+
+#include "bench_report.hpp"
+#include "bench_scene.hpp"
+#include "frame_capture.hpp"
+#include "gl_state.hpp"
+#include "gpu_timer.hpp"
+#include "headless_context.hpp"
+#include "offscreen_target.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+// Same work as the interactive loop in main.cpp.
+struct clear_scene : bench_scene {
+	void render([[maybe_unused]] std::size_t frame) override {
+		state.reset_counts();
+		state.clear_color(0.2f, 0.3f, 0.3f, 1.0f);
+		state.clear(GL_COLOR_BUFFER_BIT);
+	}
+
+	std::vector<std::string> counter_names() const override {
+		return {"gl_calls_issued", "gl_calls_elided"};
+	}
+
+	void counters(std::vector<double>& values) override {
+		values = {static_cast<double>(state.counts().issued), static_cast<double>(state.counts().elided)};
+	}
+
+	gl_state state;
+};
+
+static std::unique_ptr<bench_scene> make_scene(const bench_options& opts) {
+	if(opts.scene == "clear")
+		return std::make_unique<clear_scene>();
+	if(opts.scene == "textures")
+		return make_texture_scene(opts);
+	if(opts.scene == "textures-sync")
+		return make_texture_sync_scene(opts);
+	if(opts.scene == "textures-cache")
+		return make_texture_cache_scene(opts);
+	if(opts.scene == "simulation")
+		return make_simulation_scene(opts);
+	if(opts.scene == "instances")
+		return make_instances_scene(opts);
+	if(opts.scene == "commands")
+		return make_commands_scene(opts);
+	if(opts.scene == "shaders")
+		return make_shader_scene(opts);
+	if(opts.scene == "pack")
+		return make_pack_scene(opts);
+	return nullptr;
+}
+
+static void print_usage(const char* exe) {
+	std::cerr << "usage: " << exe << " [options]\n"
+		<< "  --scene <name>     scene to render (clear, textures, textures-sync,\n"
+		<< "                     textures-cache, simulation, instances, commands,\n"
+		<< "                     shaders, pack)\n"
+		<< "  --instances <n>    instance count for the instances scene (default 100000)\n"
+		<< "  --objects <n>      object count for the commands scene (default 20000)\n"
+		<< "  --dir <path>       image directory for the texture scenes\n"
+		<< "  --cache <path>     texture cache directory (default texture-cache)\n"
+		<< "  --pack <path>      asset pack built from --dir; the textures and shaders\n"
+		<< "                     scenes load from it instead of loose files\n"
+		<< "  --shaders <path>   shader source directory (default shaders)\n"
+		<< "  --shader-cache <path>\n"
+		<< "                     program binary directory; the shaders scene deletes\n"
+		<< "                     the .progbin files in it first (default shader-cache)\n"
+		<< "  --frames <n>       measured frames (default 600)\n"
+		<< "  --warmup <n>       frames rendered before measuring (default 60)\n"
+		<< "                     the first measured frame has no GPU time, its\n"
+		<< "                     query result is unreliable on some drivers\n"
+		<< "  --size <w>x<h>     offscreen framebuffer size (default 800x600)\n"
+		<< "  --capture <dir>    write measured frames to dir; frames are dropped\n"
+		<< "                     rather than stalling when the writer falls behind,\n"
+		<< "                     see the capture_dropped metrics and\n"
+		<< "                     --capture-lossless\n"
+		<< "  --capture-format <png|raw>\n"
+		<< "                     capture file format (default png)\n"
+		<< "  --capture-lossless stall the frame instead of dropping captures, so\n"
+		<< "                     every frame is written and runs can be diffed\n"
+		<< "  --output <path>    JSON report path (default bench.json)\n";
+}
+
+static bool parse_args(int argc, char* argv[], bench_options& opts) {
+	for(int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if(arg == "--capture-lossless") {
+			opts.capture_lossless = true;
+			continue;
+		}
+		if(i + 1 >= argc)
+			return false;
+		std::string_view value = argv[++i];
+		if(arg == "--scene")
+			opts.scene = value;
+		else if(arg == "--output")
+			opts.output = value;
+		else if(arg == "--dir")
+			opts.dir = value;
+		else if(arg == "--cache")
+			opts.cache = value;
+		else if(arg == "--pack")
+			opts.pack = value;
+		else if(arg == "--shaders")
+			opts.shaders = value;
+		else if(arg == "--shader-cache")
+			opts.shader_cache = value;
+		else if(arg == "--frames")
+			opts.frames = std::atoi(value.data());
+		else if(arg == "--warmup")
+			opts.warmup = std::atoi(value.data());
+		else if(arg == "--instances")
+			opts.instances = std::atoi(value.data());
+		else if(arg == "--objects")
+			opts.objects = std::atoi(value.data());
+		else if(arg == "--capture")
+			opts.capture = value;
+		else if(arg == "--capture-format")
+			opts.capture_format = value;
+		else if(arg == "--size") {
+			auto x = value.find('x');
+			if(x == std::string_view::npos)
+				return false;
+			opts.width = std::atoi(value.substr(0, x).data());
+			opts.height = std::atoi(value.data() + x + 1);
+		}
+		else
+			return false;
+	}
+	return opts.frames > 0 && opts.warmup >= 0 && opts.width > 0 && opts.height > 0 && opts.instances >= 0 && opts.objects >= 0
+		&& (opts.capture_format == "png" || opts.capture_format == "raw");
+}
+
+int main(int argc, char* argv[]) {
+	bench_options opts;
+	if(!parse_args(argc, argv, opts)) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	auto ctx = create_headless_context(3, 3);
+	if(!ctx) {
+		std::cerr << "failed to create headless context\n";
+		return EXIT_FAILURE;
+	}
+
+	if(!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+		std::cerr << "failed to load opengl\n";
+		std::abort();
+	}
+
+	offscreen_target target;
+	if(!create_offscreen_target(target, opts.width, opts.height))
+		std::abort();
+	glViewport(0, 0, opts.width, opts.height);
+
+	auto scene = make_scene(opts);
+	if(!scene) {
+		std::cerr << "unknown scene '" << opts.scene << "'\n";
+		return EXIT_FAILURE;
+	}
+
+	for(int i = 0; i < opts.warmup; ++i) {
+		scene->render(static_cast<std::size_t>(i));
+		glFlush();
+		scene->presented(static_cast<std::size_t>(i));
+	}
+	glFinish();
+
+	bench_report report;
+	report.scene = opts.scene;
+	report.renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	report.gl_version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	report.width = opts.width;
+	report.height = opts.height;
+	report.warmup_frames = opts.warmup;
+	report.frames.resize(static_cast<std::size_t>(opts.frames));
+	report.counter_names = scene->counter_names();
+
+	std::unique_ptr<frame_capture> capture;
+	if(!opts.capture.empty()) {
+		frame_capture_options capture_opts;
+		capture_opts.directory = opts.capture;
+		capture_opts.format = opts.capture_format == "raw" ? capture_format::raw : capture_format::png;
+		capture_opts.lossless = opts.capture_lossless;
+		capture = std::make_unique<frame_capture>(capture_opts);
+	}
+
+	std::vector<double> gpu_ms(report.frames.size(), -1.0);
+	{
+		gpu_timer timer;
+		scene->start();
+		auto start = bench_clock::now();
+		for(std::size_t i = 0; i < report.frames.size(); ++i) {
+			auto frame_start = bench_clock::now();
+			timer.begin(i);
+			scene->render(i);
+			timer.end();
+			if(capture)
+				capture->capture(i, opts.width, opts.height);
+			// stands in for the swap, which is where the driver would submit
+			glFlush();
+			scene->presented(i);
+			std::chrono::duration<double, std::milli> cpu = bench_clock::now() - frame_start;
+			report.frames[i].cpu_ms = cpu.count();
+			scene->counters(report.frames[i].counters);
+			timer.collect(gpu_ms);
+		}
+		glFinish();
+		std::chrono::duration<double, std::milli> wall = bench_clock::now() - start;
+		report.wall_ms = wall.count();
+		timer.collect(gpu_ms, true);
+	}
+	scene->finish(report);
+	if(capture) {
+		// outside the measured frames, this waits for the writer to catch up
+		capture->finish();
+		auto stats = capture->stats();
+		report.metrics.emplace_back("capture_written", static_cast<double>(stats.written));
+		report.metrics.emplace_back("capture_dropped", static_cast<double>(stats.dropped_busy + stats.dropped_queue + stats.dropped_map));
+		report.metrics.emplace_back("capture_dropped_busy", static_cast<double>(stats.dropped_busy));
+		report.metrics.emplace_back("capture_dropped_queue", static_cast<double>(stats.dropped_queue));
+		report.metrics.emplace_back("capture_dropped_map", static_cast<double>(stats.dropped_map));
+		report.metrics.emplace_back("capture_write_failed", static_cast<double>(stats.write_failed));
+		report.metrics.emplace_back("readback_latency_avg_ms", stats.latency_avg_ms);
+		report.metrics.emplace_back("readback_latency_max_ms", stats.latency_max_ms);
+		report.metrics.emplace_back("readback_latency_avg_frames", stats.latency_avg_frames);
+		capture.reset();
+	}
+	for(std::size_t i = 0; i < report.frames.size(); ++i)
+		report.frames[i].gpu_ms = gpu_ms[i];
+
+	scene.reset();
+	destroy_offscreen_target(target);
+	destroy_headless_context(*ctx);
+
+	if(!write_report_json(report, opts.output))
+		return EXIT_FAILURE;
+
+	std::vector<double> cpu_ms;
+	for(const auto& f : report.frames)
+		cpu_ms.push_back(f.cpu_ms);
+	auto cpu = summarize(cpu_ms);
+	auto gpu = summarize(gpu_ms);
+	std::cout << report.scene << ": " << report.frames.size() << " frames on " << report.renderer << "\n"
+		<< "  cpu ms: p50 " << cpu.p50 << "  p99 " << cpu.p99 << "  max " << cpu.max << "\n"
+		<< "  gpu ms: p50 " << gpu.p50 << "  p99 " << gpu.p99 << "  max " << gpu.max << "\n";
+	for(std::size_t c = 0; c < report.counter_names.size(); ++c) {
+		std::vector<double> values;
+		for(const auto& f : report.frames)
+			values.push_back(c < f.counters.size() ? f.counters[c] : -1.0);
+		std::cout << "  " << report.counter_names[c] << " per frame: mean " << summarize(values).mean << "\n";
+	}
+	for(const auto& [name, value] : report.metrics)
+		std::cout << "  " << name << ": " << value << "\n";
+	std::cout << "  report written to " << opts.output << "\n";
+	return 0;
+}
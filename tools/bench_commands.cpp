@@ -0,0 +1,208 @@
+#include <glad/glad.h>
+
+#include "bench_scene.hpp"
+#include "command_buffer.hpp"
+#include "gl_state.hpp"
+#include "shader.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using command_clock = std::chrono::steady_clock;
+
+static const char* object_vertex_source = R"(#version 330 core
+layout(location = 0) in vec3 a_position;
+
+uniform vec4 u_offset_scale;
+
+void main() {
+	gl_Position = vec4(a_position.xy * u_offset_scale.w + u_offset_scale.xy, 0.0, 1.0);
+}
+)";
+
+static const char* flat_fragment_source = R"(#version 330 core
+uniform vec4 u_tint;
+
+out vec4 frag_color;
+
+void main() {
+	frag_color = u_tint;
+}
+)";
+
+static const char* striped_fragment_source = R"(#version 330 core
+uniform vec4 u_tint;
+
+out vec4 frag_color;
+
+void main() {
+	frag_color = u_tint * (0.75 + 0.25 * step(0.5, fract(gl_FragCoord.y * 0.25)));
+}
+)";
+
+// --objects individually drawn objects, the way a renderer without instancing
+// would draw them: each one sets program, VAO and uniforms before its draw.
+// Recording is split across the thread pool into one command buffer per chunk
+// and replayed in order through a gl_state, which elides the program and VAO
+// binds repeated between neighbouring objects.
+struct commands_scene : bench_scene {
+	explicit commands_scene(const bench_options& opts)
+		: width(opts.width), height(opts.height) {
+		programs[0] = create_program(object_vertex_source, flat_fragment_source);
+		programs[1] = create_program(object_vertex_source, striped_fragment_source);
+		if(!programs[0] || !programs[1]) {
+			std::cerr << "failed to build the object programs\n";
+			std::abort();
+		}
+		for(int i = 0; i < 2; ++i) {
+			offset_scale[i] = glGetUniformLocation(programs[i], "u_offset_scale");
+			tint[i] = glGetUniformLocation(programs[i], "u_tint");
+		}
+
+		const float quad[] = {-0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f};
+		const std::uint16_t quad_indices[] = {0, 1, 2, 2, 3, 0};
+		const float triangle[] = {-0.5f, -0.4f, 0.5f, -0.4f, 0.0f, 0.5f};
+		const std::uint16_t triangle_indices[] = {0, 1, 2};
+		add_mesh(0, quad, sizeof(quad), quad_indices, sizeof(quad_indices));
+		add_mesh(1, triangle, sizeof(triangle), triangle_indices, sizeof(triangle_indices));
+
+		// grid of objects, sorted by program then mesh like a render queue would
+		const auto count = static_cast<std::size_t>(opts.objects);
+		const int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count)))));
+		const float cell = 2.0f / static_cast<float>(side);
+		objects.resize(count);
+		for(std::size_t i = 0; i < count; ++i) {
+			auto& o = objects[i];
+			o.program = static_cast<std::uint8_t>(i % 2);
+			o.mesh = static_cast<std::uint8_t>(i / 2 % 2);
+			const int x = static_cast<int>(i) % side;
+			const int y = static_cast<int>(i) / side;
+			o.x = -1.0f + (static_cast<float>(x) + 0.5f) * cell;
+			o.y = -1.0f + (static_cast<float>(y) + 0.5f) * cell;
+			o.scale = cell * 0.8f;
+			const auto h = static_cast<std::uint32_t>(i) * 2654435761u;
+			o.color[0] = static_cast<float>(h & 0xff) / 255.0f;
+			o.color[1] = static_cast<float>(h >> 8 & 0xff) / 255.0f;
+			o.color[2] = static_cast<float>(h >> 16 & 0xff) / 255.0f;
+			o.color[3] = 1.0f;
+		}
+		std::stable_sort(objects.begin(), objects.end(), [](const object& a, const object& b) {
+			return a.program != b.program ? a.program < b.program : a.mesh < b.mesh;
+		});
+
+		buffers.resize(static_cast<std::size_t>(pool.size()) * 2);
+	}
+
+	~commands_scene() override {
+		glDeleteProgram(programs[0]);
+		glDeleteProgram(programs[1]);
+		for(int i = 0; i < 2; ++i) {
+			glDeleteVertexArrays(1, &meshes[i]);
+			glDeleteBuffers(2, mesh_buffers[i]);
+		}
+	}
+
+	void add_mesh(int slot, const float* vertices, std::size_t vertex_bytes, const std::uint16_t* indices, std::size_t index_bytes) {
+		auto* b = mesh_buffers[slot];
+		glGenVertexArrays(1, &meshes[slot]);
+		glBindVertexArray(meshes[slot]);
+		glGenBuffers(2, b);
+		glBindBuffer(GL_ARRAY_BUFFER, b[0]);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertex_bytes), vertices, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+		glEnableVertexAttribArray(0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, b[1]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_bytes), indices, GL_STATIC_DRAW);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		index_counts[slot] = static_cast<GLsizei>(index_bytes / sizeof(std::uint16_t));
+	}
+
+	void record(command_buffer& cmd, std::size_t chunk, float t) const {
+		if(chunk == 0) {
+			cmd.viewport(0, 0, width, height);
+			cmd.clear_color(0.2f, 0.3f, 0.3f, 1.0f);
+			cmd.clear(GL_COLOR_BUFFER_BIT);
+		}
+		const auto per_chunk = (objects.size() + buffers.size() - 1) / buffers.size();
+		const auto begin = std::min(objects.size(), chunk * per_chunk);
+		const auto end = std::min(objects.size(), begin + per_chunk);
+		for(auto i = begin; i < end; ++i) {
+			const auto& o = objects[i];
+			const float pulse = 0.85f + 0.15f * std::sin(t + static_cast<float>(i) * 0.01f);
+			const float placement[4] = {o.x, o.y, 0.0f, o.scale * pulse};
+			cmd.use_program(programs[o.program]);
+			cmd.bind_vertex_array(meshes[o.mesh]);
+			cmd.uniform4f(offset_scale[o.program], placement);
+			cmd.uniform4f(tint[o.program], o.color);
+			cmd.draw_elements(GL_TRIANGLES, index_counts[o.mesh], GL_UNSIGNED_SHORT, 0);
+		}
+	}
+
+	void render(std::size_t frame) override {
+		state.reset_counts();
+		const float t = static_cast<float>(frame) * 0.05f;
+
+		auto record_start = command_clock::now();
+		record_parallel(pool, buffers, [&](command_buffer& cmd, std::size_t chunk) {
+			record(cmd, chunk, t);
+		});
+		auto replay_start = command_clock::now();
+		for(const auto& cmd : buffers)
+			cmd.execute(state);
+		auto replay_end = command_clock::now();
+
+		record_ms = std::chrono::duration<double, std::milli>(replay_start - record_start).count();
+		replay_ms = std::chrono::duration<double, std::milli>(replay_end - replay_start).count();
+	}
+
+	std::vector<std::string> counter_names() const override {
+		return {"gl_calls_issued", "gl_calls_elided", "record_ms", "replay_ms"};
+	}
+
+	void counters(std::vector<double>& values) override {
+		const auto& c = state.counts();
+		values = {static_cast<double>(c.issued), static_cast<double>(c.elided), record_ms, replay_ms};
+	}
+
+	void finish(bench_report& report) override {
+		report.metrics.emplace_back("objects", static_cast<double>(objects.size()));
+		report.metrics.emplace_back("command_buffers", static_cast<double>(buffers.size()));
+		report.metrics.emplace_back("workers", static_cast<double>(pool.size()));
+	}
+
+	struct object {
+		std::uint8_t program = 0;
+		std::uint8_t mesh = 0;
+		float x = 0.0f;
+		float y = 0.0f;
+		float scale = 1.0f;
+		float color[4] = {};
+	};
+
+	int width = 0;
+	int height = 0;
+	GLuint programs[2] = {};
+	GLint offset_scale[2] = {};
+	GLint tint[2] = {};
+	GLuint meshes[2] = {};
+	GLuint mesh_buffers[2][2] = {};
+	GLsizei index_counts[2] = {};
+	std::vector<object> objects;
+
+	thread_pool pool;
+	std::vector<command_buffer> buffers;
+	gl_state state;
+	double record_ms = 0.0;
+	double replay_ms = 0.0;
+};
+
+std::unique_ptr<bench_scene> make_commands_scene(const bench_options& opts) {
+	return std::make_unique<commands_scene>(opts);
+}
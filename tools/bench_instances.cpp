@@ -0,0 +1,115 @@
+#include <glad/glad.h>
+
+#include "batch_renderer.hpp"
+#include "bench_scene.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Stress test for batch_renderer: --instances quads and triangles spread over
+// four materials, every instance resubmitted and rotating each frame.
+struct instances_scene : bench_scene {
+	explicit instances_scene(const bench_options& opts)
+		: aspect(static_cast<float>(opts.width) / static_cast<float>(opts.height)) {
+		const float quad[] = {
+			-0.5f, -0.5f, 0.0f,
+			0.5f, -0.5f, 0.0f,
+			0.5f, 0.5f, 0.0f,
+			-0.5f, 0.5f, 0.0f,
+		};
+		const std::uint16_t quad_indices[] = {0, 1, 2, 2, 3, 0};
+		const float triangle[] = {
+			-0.5f, -0.4f, 0.0f,
+			0.5f, -0.4f, 0.0f,
+			0.0f, 0.5f, 0.0f,
+		};
+		const std::uint16_t triangle_indices[] = {0, 1, 2};
+		meshes[0] = renderer.add_mesh(quad, quad_indices);
+		meshes[1] = renderer.add_mesh(triangle, triangle_indices);
+
+		const float tints[4][4] = {
+			{1.0f, 1.0f, 1.0f, 1.0f},
+			{1.0f, 0.6f, 0.6f, 1.0f},
+			{0.6f, 1.0f, 0.6f, 1.0f},
+			{0.6f, 0.6f, 1.0f, 1.0f},
+		};
+		for(int i = 0; i < 4; ++i)
+			materials[i] = renderer.add_material(tints[i]);
+
+		// square grid filling the view
+		const auto count = static_cast<std::size_t>(opts.instances);
+		const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+		const float cell = 2.0f / static_cast<float>(side > 0 ? side : 1);
+		positions.reserve(count * 3);
+		colors.reserve(count);
+		for(std::size_t i = 0; i < count; ++i) {
+			const int x = static_cast<int>(i) % side;
+			const int y = static_cast<int>(i) / side;
+			positions.insert(positions.end(), {
+				(-1.0f + (static_cast<float>(x) + 0.5f) * cell) * aspect,
+				-1.0f + (static_cast<float>(y) + 0.5f) * cell,
+				0.0f,
+			});
+			auto h = static_cast<std::uint32_t>(i) * 2654435761u;
+			colors.push_back(h | 0xff000000u);
+		}
+		scale = cell * 0.8f;
+	}
+
+	void render(std::size_t frame) override {
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		const float t = static_cast<float>(frame) * 0.02f;
+		for(std::size_t i = 0; i < colors.size(); ++i) {
+			renderer.submit(materials[i % 4], meshes[(i / 4) % 2], &positions[i * 3], scale,
+				t + static_cast<float>(i) * 0.001f, colors[i]);
+		}
+
+		// orthographic, x scaled down by the aspect ratio
+		const float view_proj[16] = {
+			1.0f / aspect, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f,
+		};
+		renderer.flush(view_proj);
+		total_bytes += renderer.last_frame().bytes_uploaded;
+		fence_waits += renderer.last_frame().fence_waits;
+	}
+
+	std::vector<std::string> counter_names() const override {
+		return {"draw_calls", "instances", "bytes_uploaded"};
+	}
+
+	void counters(std::vector<double>& values) override {
+		const auto& s = renderer.last_frame();
+		values = {static_cast<double>(s.draw_calls), static_cast<double>(s.instances), static_cast<double>(s.bytes_uploaded)};
+	}
+
+	void start() override {
+		total_bytes = 0;
+		fence_waits = 0;
+	}
+
+	void finish(bench_report& report) override {
+		report.metrics.emplace_back("instances", static_cast<double>(colors.size()));
+		report.metrics.emplace_back("bytes_uploaded_total", static_cast<double>(total_bytes));
+		report.metrics.emplace_back("fence_waits", static_cast<double>(fence_waits));
+	}
+
+	batch_renderer renderer;
+	mesh_id meshes[2] = {};
+	material_id materials[4] = {};
+	std::vector<float> positions;
+	std::vector<std::uint32_t> colors;
+	float aspect = 1.0f;
+	float scale = 1.0f;
+	std::size_t total_bytes = 0;
+	std::size_t fence_waits = 0;
+};
+
+std::unique_ptr<bench_scene> make_instances_scene(const bench_options& opts) {
+	return std::make_unique<instances_scene>(opts);
+}
@@ -0,0 +1,143 @@
+#include <glad/glad.h>
+
+#include "asset_pack.hpp"
+#include "bench_scene.hpp"
+#include "image_decode.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using pack_clock = std::chrono::steady_clock;
+
+bool is_image_asset(std::string_view name) {
+	for(std::string_view ext : {".png", ".jpg", ".jpeg", ".bmp", ".tga"}) {
+		if(name.ends_with(ext))
+			return true;
+	}
+	return false;
+}
+
+static double elapsed_ms(pack_clock::time_point since) {
+	return std::chrono::duration<double, std::milli>(pack_clock::now() - since).count();
+}
+
+// Reads one byte per page so mapped data is actually faulted in, the way a
+// consumer would, without the checksum itself costing much.
+static std::uint8_t touch(std::span<const std::byte> bytes) {
+	std::uint8_t sum = 0;
+	for(std::size_t i = 0; i < bytes.size(); i += 4096)
+		sum ^= static_cast<std::uint8_t>(bytes[i]);
+	return sum;
+}
+
+// Loads everything under --dir as loose files and everything in --pack (built
+// from the same directory with asset-packer), once just reading and once also
+// decoding the images, all on one thread in the first measured frame.
+//
+// Whichever goes second may find more of its data in the page cache; run it
+// twice or drop caches in between to compare cold reads.
+struct pack_scene : bench_scene {
+	explicit pack_scene(const bench_options& opts)
+		: dir(opts.dir), pack_path(opts.pack) {
+		std::error_code ec;
+		for(const auto& entry : fs::recursive_directory_iterator(dir, ec)) {
+			if(entry.is_regular_file())
+				names.push_back(entry.path().lexically_relative(dir).generic_string());
+		}
+		if(ec)
+			std::cerr << "failed to list " << dir << ": " << ec.message() << "\n";
+		std::sort(names.begin(), names.end());
+	}
+
+	void start() override {
+		pending = true;
+	}
+
+	void render([[maybe_unused]] std::size_t frame) override {
+		if(pending) {
+			loose_read_ms = load_loose(false);
+			pack_read_ms = load_pack(false);
+			loose_decode_ms = load_loose(true);
+			pack_decode_ms = load_pack(true);
+			pending = false;
+		}
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
+
+	void finish(bench_report& report) override {
+		report.metrics.emplace_back("assets", static_cast<double>(names.size()));
+		report.metrics.emplace_back("bytes", static_cast<double>(bytes));
+		report.metrics.emplace_back("missing", static_cast<double>(missing));
+		report.metrics.emplace_back("loose_read_ms", loose_read_ms);
+		report.metrics.emplace_back("pack_read_ms", pack_read_ms);
+		report.metrics.emplace_back("loose_read_decode_ms", loose_decode_ms);
+		report.metrics.emplace_back("pack_read_decode_ms", pack_decode_ms);
+		report.metrics.emplace_back("checksum", static_cast<double>(checksum));
+	}
+
+	void consume(const std::string& name, std::span<const std::byte> data, bool decode) {
+		checksum ^= touch(data);
+		if(decode && is_image_asset(name)) {
+			auto image = decode_rgba8(data);
+			if(image.pixels)
+				checksum ^= image.pixels.get()[0];
+		}
+	}
+
+	double load_loose(bool decode) {
+		auto started = pack_clock::now();
+		std::vector<std::byte> data;
+		bytes = 0;
+		for(const auto& name : names) {
+			std::ifstream in(fs::path(dir) / name, std::ios::binary | std::ios::ate);
+			if(!in)
+				continue;
+			data.resize(static_cast<std::size_t>(in.tellg()));
+			in.seekg(0);
+			in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+			bytes += data.size();
+			consume(name, data, decode);
+		}
+		return elapsed_ms(started);
+	}
+
+	double load_pack(bool decode) {
+		auto started = pack_clock::now();
+		asset_pack pack(pack_path);
+		missing = 0;
+		asset_bytes asset;
+		for(const auto& name : names) {
+			if(!pack.load(name, asset)) {
+				++missing;
+				continue;
+			}
+			consume(name, asset.bytes(), decode);
+		}
+		return elapsed_ms(started);
+	}
+
+	std::string dir;
+	std::string pack_path;
+	std::vector<std::string> names;
+	std::size_t bytes = 0;
+	std::size_t missing = 0;
+	std::uint8_t checksum = 0;
+	bool pending = false;
+	double loose_read_ms = -1.0;
+	double pack_read_ms = -1.0;
+	double loose_decode_ms = -1.0;
+	double pack_decode_ms = -1.0;
+};
+
+std::unique_ptr<bench_scene> make_pack_scene(const bench_options& opts) {
+	return std::make_unique<pack_scene>(opts);
+}
@@ -0,0 +1,118 @@
+#include "bench_report.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+timing_summary summarize(std::vector<double> values) {
+	std::erase_if(values, [](double v) { return v < 0.0; });
+	timing_summary s;
+	s.count = values.size();
+	if(values.empty())
+		return s;
+
+	std::sort(values.begin(), values.end());
+	// nearest-rank percentile
+	auto percentile = [&](double p) {
+		auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(values.size())));
+		return values[std::clamp<std::size_t>(rank, 1, values.size()) - 1];
+	};
+	s.min = values.front();
+	s.max = values.back();
+	s.mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+	s.p50 = percentile(50.0);
+	s.p90 = percentile(90.0);
+	s.p95 = percentile(95.0);
+	s.p99 = percentile(99.0);
+	return s;
+}
+
+static std::string escape_json(const std::string& str) {
+	std::string out;
+	out.reserve(str.size());
+	for(char c : str) {
+		switch(c) {
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if(static_cast<unsigned char>(c) >= 0x20)
+				out += c;
+		}
+	}
+	return out;
+}
+
+static void write_summary(std::ostream& out, const timing_summary& s) {
+	out << "{\"count\": " << s.count
+		<< ", \"min\": " << s.min
+		<< ", \"mean\": " << s.mean
+		<< ", \"p50\": " << s.p50
+		<< ", \"p90\": " << s.p90
+		<< ", \"p95\": " << s.p95
+		<< ", \"p99\": " << s.p99
+		<< ", \"max\": " << s.max << "}";
+}
+
+bool write_report_json(const bench_report& report, const std::string& path) {
+	std::ofstream out(path);
+	if(!out) {
+		std::cerr << "failed to open " << path << " for writing\n";
+		return false;
+	}
+
+	std::vector<double> cpu, gpu;
+	cpu.reserve(report.frames.size());
+	gpu.reserve(report.frames.size());
+	for(const auto& f : report.frames) {
+		cpu.push_back(f.cpu_ms);
+		gpu.push_back(f.gpu_ms);
+	}
+
+	out.precision(12);
+	out << "{\n";
+	out << "  \"scene\": \"" << escape_json(report.scene) << "\",\n";
+	out << "  \"renderer\": \"" << escape_json(report.renderer) << "\",\n";
+	out << "  \"gl_version\": \"" << escape_json(report.gl_version) << "\",\n";
+	out << "  \"width\": " << report.width << ",\n";
+	out << "  \"height\": " << report.height << ",\n";
+	out << "  \"warmup_frames\": " << report.warmup_frames << ",\n";
+	out << "  \"frame_count\": " << report.frames.size() << ",\n";
+	out << "  \"wall_ms\": " << report.wall_ms << ",\n";
+	out << "  \"cpu_ms\": ";
+	write_summary(out, summarize(cpu));
+	out << ",\n  \"gpu_ms\": ";
+	write_summary(out, summarize(gpu));
+	out << ",\n  \"counters\": {";
+	for(std::size_t c = 0; c < report.counter_names.size(); ++c) {
+		std::vector<double> values;
+		values.reserve(report.frames.size());
+		for(const auto& f : report.frames)
+			values.push_back(c < f.counters.size() ? f.counters[c] : -1.0);
+		out << (c ? ",\n    " : "\n    ") << "\"" << escape_json(report.counter_names[c]) << "\": ";
+		write_summary(out, summarize(values));
+	}
+	out << (report.counter_names.empty() ? "}" : "\n  }");
+	out << ",\n  \"metrics\": {";
+	for(std::size_t i = 0; i < report.metrics.size(); ++i) {
+		const auto& [name, value] = report.metrics[i];
+		out << (i ? ", " : "") << "\"" << escape_json(name) << "\": " << value;
+	}
+	out << "},\n  \"frames\": [\n";
+	for(std::size_t i = 0; i < report.frames.size(); ++i) {
+		const auto& f = report.frames[i];
+		out << "    {\"cpu_ms\": " << f.cpu_ms << ", \"gpu_ms\": ";
+		if(f.gpu_ms < 0.0)
+			out << "null";
+		else
+			out << f.gpu_ms;
+		for(std::size_t c = 0; c < f.counters.size() && c < report.counter_names.size(); ++c)
+			out << ", \"" << escape_json(report.counter_names[c]) << "\": " << f.counters[c];
+		out << "}" << (i + 1 < report.frames.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+struct frame_sample {
+	double cpu_ms = 0.0;
+	double gpu_ms = -1.0; // stays negative if the timer query was never resolved
+	std::vector<double> counters;
+};
+
+struct timing_summary {
+	std::size_t count = 0;
+	double min = 0.0;
+	double mean = 0.0;
+	double p50 = 0.0;
+	double p90 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+};
+
+struct bench_report {
+	std::string scene;
+	std::string renderer;
+	std::string gl_version;
+	int width = 0;
+	int height = 0;
+	int warmup_frames = 0;
+	double wall_ms = 0.0;
+	std::vector<frame_sample> frames;
+	// names of frame_sample::counters
+	std::vector<std::string> counter_names;
+	// scene specific results, e.g. total load time
+	std::vector<std::pair<std::string, double>> metrics;
+};
+
+// Negative values are treated as missing and skipped.
+timing_summary summarize(std::vector<double> values);
+
+bool write_report_json(const bench_report& report, const std::string& path);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "bench_report.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct bench_options {
+	std::string scene = "clear";
+	std::string output = "bench.json";
+	std::string dir;
+	std::string cache = "texture-cache";
+	std::string pack;
+	std::string shaders = "shaders";
+	std::string shader_cache = "shader-cache";
+	std::string capture;
+	std::string capture_format = "png";
+	bool capture_lossless = false;
+	int instances = 100000;
+	int objects = 20000;
+	int frames = 600;
+	int warmup = 60;
+	int width = 800;
+	int height = 600;
+};
+
+struct bench_scene {
+	virtual ~bench_scene() = default;
+	// called once after warmup, right before the first measured frame
+	virtual void start() {}
+	virtual void render(std::size_t frame) = 0;
+	// called after the frame has been submitted, where a window would swap
+	virtual void presented([[maybe_unused]] std::size_t frame) {}
+	// per-frame counters recorded next to the timings, in counter_names() order
+	virtual std::vector<std::string> counter_names() const { return {}; }
+	virtual void counters([[maybe_unused]] std::vector<double>& values) {}
+	// adds scene specific metrics once all frames are done
+	virtual void finish([[maybe_unused]] bench_report& report) {}
+};
+
+// bench_textures.cpp
+std::unique_ptr<bench_scene> make_texture_scene(const bench_options& opts);
+std::unique_ptr<bench_scene> make_texture_sync_scene(const bench_options& opts);
+std::unique_ptr<bench_scene> make_texture_cache_scene(const bench_options& opts);
+
+// bench_commands.cpp
+std::unique_ptr<bench_scene> make_commands_scene(const bench_options& opts);
+
+// bench_instances.cpp
+std::unique_ptr<bench_scene> make_instances_scene(const bench_options& opts);
+
+// bench_pack.cpp
+bool is_image_asset(std::string_view name);
+std::unique_ptr<bench_scene> make_pack_scene(const bench_options& opts);
+
+// bench_shaders.cpp
+std::unique_ptr<bench_scene> make_shader_scene(const bench_options& opts);
+
+// bench_simulation.cpp
+std::unique_ptr<bench_scene> make_simulation_scene(const bench_options& opts);
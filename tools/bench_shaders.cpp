@@ -0,0 +1,124 @@
+#include <glad/glad.h>
+
+#include "asset_pack.hpp"
+#include "bench_scene.hpp"
+#include "shader_manager.hpp"
+
+#include <EGL/egl.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+using shader_clock = std::chrono::steady_clock;
+
+static const std::vector<std::string> pattern_flags = {"GRADIENT", "STRIPES", "VIGNETTE", "NOISE", "TINT"};
+
+struct shader_startup {
+	double submit_ms = 0.0;
+	double ready_ms = 0.0;
+	shader_stats stats;
+};
+
+// Builds every pattern variant and polls until all of them are usable, the
+// way a loading screen would. Returns the manager so the scene can keep it.
+// With a pack, sources are read from it instead of from files.
+static std::unique_ptr<shader_manager> start_shaders(const bench_options& opts, const asset_pack* pack,
+	std::vector<variant_id>& ids, shader_startup& startup) {
+	shader_manager_options options;
+	options.cache_dir = opts.shader_cache;
+	options.load = reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+	options.watch_interval = std::chrono::milliseconds(250);
+	if(pack) {
+		options.read_source = [pack](const std::string& name) -> std::optional<std::string> {
+			asset_bytes text;
+			if(!pack->load(name, text))
+				return std::nullopt;
+			return std::string(reinterpret_cast<const char*>(text.bytes().data()), text.bytes().size());
+		};
+	}
+
+	auto start = shader_clock::now();
+	auto shaders = std::make_unique<shader_manager>(options);
+	const auto vertex = (std::filesystem::path(opts.shaders) / "fullscreen.vert").generic_string();
+	const auto fragment = (std::filesystem::path(opts.shaders) / "pattern.frag").generic_string();
+	ids.clear();
+	for(auto& defines : define_permutations(pattern_flags))
+		ids.push_back(shaders->add({vertex, fragment, std::move(defines)}));
+	auto submitted = shader_clock::now();
+	while(shaders->poll() > 0) {}
+	auto ready = shader_clock::now();
+
+	startup.submit_ms = std::chrono::duration<double, std::milli>(submitted - start).count();
+	startup.ready_ms = std::chrono::duration<double, std::milli>(ready - start).count();
+	startup.stats = shaders->stats();
+	return shaders;
+}
+
+// Startup with an empty program binary cache, then again with the cache the
+// first run filled. Frames cycle through the variants and keep polling, so
+// editing the shader files while it runs exercises hot reload.
+//
+// The driver may have a shader cache of its own, in which case the cold run
+// only measures our side of it. With --pack, --shaders is the directory
+// inside the pack.
+struct shader_scene : bench_scene {
+	explicit shader_scene(const bench_options& opts)
+		: pack(opts.pack.empty() ? asset_pack() : asset_pack(opts.pack)) {
+		clear_program_binaries(opts.shader_cache);
+		const auto* source_pack = pack.is_open() ? &pack : nullptr;
+		start_shaders(opts, source_pack, ids, cold);
+		shaders = start_shaders(opts, source_pack, ids, warm);
+		parallel = shaders->parallel_compile();
+		binaries = shaders->program_binaries();
+
+		glGenVertexArrays(1, &vao);
+	}
+
+	~shader_scene() override {
+		glDeleteVertexArrays(1, &vao);
+	}
+
+	void render(std::size_t frame) override {
+		shaders->poll();
+		GLuint program = shaders->program(ids[frame % ids.size()]);
+		if(!program)
+			return;
+		glUseProgram(program);
+		glUniform1f(glGetUniformLocation(program, "u_time"), static_cast<float>(frame) * 0.02f);
+		const float tint[4] = {1.0f, 0.8f, 0.6f, 1.0f};
+		glUniform4fv(glGetUniformLocation(program, "u_tint"), 1, tint);
+		glBindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+
+	void finish(bench_report& report) override {
+		report.metrics.emplace_back("variants", static_cast<double>(ids.size()));
+		report.metrics.emplace_back("parallel_compile", parallel ? 1.0 : 0.0);
+		report.metrics.emplace_back("program_binaries", binaries ? 1.0 : 0.0);
+		report.metrics.emplace_back("cold_submit_ms", cold.submit_ms);
+		report.metrics.emplace_back("cold_ready_ms", cold.ready_ms);
+		report.metrics.emplace_back("cold_compiled", static_cast<double>(cold.stats.compiled));
+		report.metrics.emplace_back("warm_submit_ms", warm.submit_ms);
+		report.metrics.emplace_back("warm_ready_ms", warm.ready_ms);
+		report.metrics.emplace_back("warm_cache_hits", static_cast<double>(warm.stats.cache_hits));
+		report.metrics.emplace_back("failed", static_cast<double>(shaders->stats().failed));
+		report.metrics.emplace_back("reloads", static_cast<double>(shaders->stats().reloads));
+	}
+
+	asset_pack pack;
+	std::unique_ptr<shader_manager> shaders;
+	std::vector<variant_id> ids;
+	shader_startup cold;
+	shader_startup warm;
+	bool parallel = false;
+	bool binaries = false;
+	GLuint vao = 0;
+};
+
+std::unique_ptr<bench_scene> make_shader_scene(const bench_options& opts) {
+	return std::make_unique<shader_scene>(opts);
+}
@@ -0,0 +1,47 @@
+#include <glad/glad.h>
+
+#include "bench_scene.hpp"
+#include "loop_stats.hpp"
+#include "simulation.hpp"
+
+// Renders snapshots from the simulation thread the same way main.cpp does and
+// injects a key press every 30 frames to measure input-to-present latency.
+struct simulation_scene : bench_scene {
+	void start() override {
+		measuring = true;
+	}
+
+	void render(std::size_t frame) override {
+		if(measuring && frame % 30 == 0)
+			sim.push_input({input_action::toggle_animation, 0, 0, sim_clock::now()});
+
+		snap = &sim.latest();
+		auto state = sim.interpolate(*snap, sim_clock::now());
+		glClearColor(state.color[0], state.color[1], state.color[2], 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
+
+	void presented([[maybe_unused]] std::size_t frame) override {
+		if(measuring)
+			stats.frame_presented(sim_clock::now(), sim.ticks(), snap->input_seq, snap->input_time);
+	}
+
+	void finish(bench_report& report) override {
+		auto totals = stats.totals(sim_clock::now());
+		report.metrics.emplace_back("update_hz", totals.update_hz);
+		report.metrics.emplace_back("render_hz", totals.render_hz);
+		report.metrics.emplace_back("input_latency_avg_ms", totals.latency_avg_ms);
+		report.metrics.emplace_back("input_latency_max_ms", totals.latency_max_ms);
+		report.metrics.emplace_back("input_latency_samples", static_cast<double>(totals.latency_samples));
+		report.metrics.emplace_back("dropped_inputs", static_cast<double>(sim.dropped_inputs()));
+	}
+
+	simulation sim;
+	loop_stats stats;
+	const sim_snapshot* snap = nullptr;
+	bool measuring = false;
+};
+
+std::unique_ptr<bench_scene> make_simulation_scene([[maybe_unused]] const bench_options& opts) {
+	return std::make_unique<simulation_scene>();
+}
@@ -0,0 +1,188 @@
+#include <glad/glad.h>
+
+#include "asset_pack.hpp"
+#include "bench_scene.hpp"
+#include "texture_cache.hpp"
+#include "texture_loader.hpp"
+#include "thread_pool.hpp"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+static std::vector<std::string> list_images(const std::string& dir) {
+	std::vector<std::string> paths;
+	std::error_code ec;
+	for(const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+		if(entry.is_regular_file())
+			paths.push_back(entry.path().string());
+	}
+	if(ec)
+		std::cerr << "failed to list " << dir << ": " << ec.message() << "\n";
+	std::sort(paths.begin(), paths.end());
+	return paths;
+}
+
+static double elapsed_ms(bench_clock::time_point since) {
+	return std::chrono::duration<double, std::milli>(bench_clock::now() - since).count();
+}
+
+static std::vector<std::string> list_pack_images(const asset_pack& pack) {
+	std::vector<std::string> names;
+	for(const auto& entry : pack.index()) {
+		if(auto name = pack.name(entry); is_image_asset(name))
+			names.emplace_back(name);
+	}
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+static texture_loader_options pack_loader_options(const asset_pack& pack) {
+	texture_loader_options options;
+	if(pack.is_open())
+		options.pack = &pack;
+	return options;
+}
+
+// Loads every file in --dir through texture_loader while rendering, so the
+// frame time distribution shows how much the uploads hitch. With --pack the
+// images in the pack are loaded instead.
+struct texture_scene : bench_scene {
+	explicit texture_scene(const bench_options& opts)
+		: pack(opts.pack.empty() ? asset_pack() : asset_pack(opts.pack)),
+		paths(pack.is_open() ? list_pack_images(pack) : list_images(opts.dir)),
+		loader(pool, pack_loader_options(pack)) {}
+
+	void start() override {
+		started = bench_clock::now();
+		for(const auto& path : paths)
+			loader.load(path);
+		loading = true;
+	}
+
+	void render([[maybe_unused]] std::size_t frame) override {
+		uploaded_max = std::max(uploaded_max, loader.update());
+		if(loading && loader.idle()) {
+			load_ms = elapsed_ms(started);
+			loading = false;
+		}
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
+
+	void finish(bench_report& report) override {
+		const auto& stats = loader.get_stats();
+		report.metrics.emplace_back("textures", static_cast<double>(stats.requested));
+		report.metrics.emplace_back("textures_failed", static_cast<double>(stats.failed));
+		report.metrics.emplace_back("bytes_uploaded", static_cast<double>(stats.bytes_uploaded));
+		report.metrics.emplace_back("max_bytes_per_frame", static_cast<double>(uploaded_max));
+		report.metrics.emplace_back("decode_threads", static_cast<double>(pool.size()));
+		// stays negative if loading didn't finish within the measured frames
+		report.metrics.emplace_back("total_load_ms", load_ms);
+	}
+
+	asset_pack pack;
+	std::vector<std::string> paths;
+	thread_pool pool;
+	texture_loader loader;
+	bench_clock::time_point started;
+	std::size_t uploaded_max = 0;
+	bool loading = false;
+	double load_ms = -1.0;
+};
+
+// Baseline: stbi_load + glTexImage2D for every file inside the first
+// measured frame. With a cache directory, textures are taken from the
+// texture cache instead and only misses are decoded.
+struct texture_sync_scene : bench_scene {
+	texture_sync_scene(const bench_options& opts, std::string cache_dir)
+		: paths(list_images(opts.dir)), cache_dir(std::move(cache_dir)) {}
+
+	~texture_sync_scene() override {
+		glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+	}
+
+	void start() override {
+		pending = true;
+	}
+
+	void render([[maybe_unused]] std::size_t frame) override {
+		if(pending) {
+			auto started = bench_clock::now();
+			for(const auto& path : paths)
+				load(path);
+			load_ms = elapsed_ms(started);
+			pending = false;
+		}
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
+
+	void finish(bench_report& report) override {
+		report.metrics.emplace_back("textures", static_cast<double>(paths.size()));
+		report.metrics.emplace_back("textures_failed", static_cast<double>(failed));
+		report.metrics.emplace_back("bytes_uploaded", static_cast<double>(bytes));
+		if(!cache_dir.empty()) {
+			report.metrics.emplace_back("cache_hits", static_cast<double>(cache_hits));
+			report.metrics.emplace_back("cache_misses", static_cast<double>(paths.size() - cache_hits));
+		}
+		report.metrics.emplace_back("total_load_ms", load_ms);
+	}
+
+	void load(const std::string& path) {
+		if(!cache_dir.empty()) {
+			if(auto tex = load_cached_texture(texture_cache_path(cache_dir, path), path)) {
+				textures.push_back(tex);
+				++cache_hits;
+				return;
+			}
+		}
+
+		int w = 0, h = 0, channels = 0;
+		auto* pixels = stbi_load(path.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+		if(!pixels) {
+			std::cerr << "failed to load " << path << ": " << stbi_failure_reason() << "\n";
+			++failed;
+			return;
+		}
+		GLuint tex = 0;
+		glGenTextures(1, &tex);
+		glBindTexture(GL_TEXTURE_2D, tex);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		stbi_image_free(pixels);
+		textures.push_back(tex);
+		bytes += static_cast<std::size_t>(w) * static_cast<std::size_t>(h) * 4;
+	}
+
+	std::vector<std::string> paths;
+	std::string cache_dir;
+	std::vector<GLuint> textures;
+	std::size_t cache_hits = 0;
+	std::size_t failed = 0;
+	std::size_t bytes = 0;
+	bool pending = false;
+	double load_ms = -1.0;
+};
+
+std::unique_ptr<bench_scene> make_texture_scene(const bench_options& opts) {
+	return std::make_unique<texture_scene>(opts);
+}
+
+std::unique_ptr<bench_scene> make_texture_sync_scene(const bench_options& opts) {
+	return std::make_unique<texture_sync_scene>(opts, std::string{});
+}
+
+std::unique_ptr<bench_scene> make_texture_cache_scene(const bench_options& opts) {
+	return std::make_unique<texture_sync_scene>(opts, opts.cache);
+}
@@ -0,0 +1,198 @@
+#include "image_ops.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Microbenchmark for the image_ops kernels, laid out like Google Benchmark's
+// console output. Before timing, every SIMD level's output is compared with
+// the scalar one on the same input, including odd sizes that exercise the
+// border paths; any difference fails the run.
+
+using bench_clock = std::chrono::steady_clock;
+
+struct bench_buffers {
+	std::vector<std::uint8_t> gray;
+	std::vector<std::uint8_t> rgb;
+	std::vector<std::uint8_t> rgba;
+	std::vector<float> linear;
+	std::vector<std::uint8_t> out8;
+	std::vector<float> out_float;
+};
+
+struct kernel_case {
+	const char* name;
+	// input + output bytes touched per source pixel
+	double bytes_per_pixel;
+	// returns the output to compare between SIMD levels
+	std::span<const std::byte> (*run)(bench_buffers& b, int width, int height);
+};
+
+static std::size_t pixel_count(int width, int height) {
+	return static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+}
+
+static std::size_t half(int size) {
+	return static_cast<std::size_t>(std::max(1, size / 2));
+}
+
+static const kernel_case cases[] = {
+	{"expand_rgb", 3 + 4, [](bench_buffers& b, int w, int h) {
+		expand_rgb_to_rgba8(b.rgb.data(), b.out8.data(), pixel_count(w, h));
+		return std::as_bytes(std::span(b.out8).first(pixel_count(w, h) * 4));
+	}},
+	{"expand_gray", 1 + 4, [](bench_buffers& b, int w, int h) {
+		expand_gray_to_rgba8(b.gray.data(), b.out8.data(), pixel_count(w, h));
+		return std::as_bytes(std::span(b.out8).first(pixel_count(w, h) * 4));
+	}},
+	{"srgb_to_linear", 4 + 16, [](bench_buffers& b, int w, int h) {
+		srgb_to_linear_rgba8(b.rgba.data(), b.out_float.data(), pixel_count(w, h));
+		return std::as_bytes(std::span(b.out_float).first(pixel_count(w, h) * 4));
+	}},
+	{"linear_to_srgb", 16 + 4, [](bench_buffers& b, int w, int h) {
+		linear_to_srgb_rgba8(b.linear.data(), b.out8.data(), pixel_count(w, h));
+		return std::as_bytes(std::span(b.out8).first(pixel_count(w, h) * 4));
+	}},
+	{"premultiply", 4 + 4, [](bench_buffers& b, int w, int h) {
+		premultiply_alpha_rgba8(b.rgba.data(), b.out8.data(), pixel_count(w, h));
+		return std::as_bytes(std::span(b.out8).first(pixel_count(w, h) * 4));
+	}},
+	{"downsample_box", 4 + 1, [](bench_buffers& b, int w, int h) {
+		downsample_box_rgba8(b.rgba.data(), w, h, b.out8.data());
+		return std::as_bytes(std::span(b.out8).first(half(w) * half(h) * 4));
+	}},
+	{"downsample_kaiser", 4 + 1, [](bench_buffers& b, int w, int h) {
+		downsample_kaiser_rgba8(b.rgba.data(), w, h, b.out8.data());
+		return std::as_bytes(std::span(b.out8).first(half(w) * half(h) * 4));
+	}},
+};
+
+static void fill_buffers(bench_buffers& b, std::size_t pixels) {
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> byte(0, 255);
+	// slightly out of range so the clamps get exercised too
+	std::uniform_real_distribution<float> linear(-0.1f, 1.1f);
+	b.gray.resize(pixels);
+	b.rgb.resize(pixels * 3);
+	b.rgba.resize(pixels * 4);
+	b.linear.resize(pixels * 4);
+	b.out8.assign(pixels * 4, 0);
+	b.out_float.assign(pixels * 4, 0.0f);
+	for(auto& v : b.gray) v = static_cast<std::uint8_t>(byte(rng));
+	for(auto& v : b.rgb) v = static_cast<std::uint8_t>(byte(rng));
+	for(auto& v : b.rgba) v = static_cast<std::uint8_t>(byte(rng));
+	for(auto& v : b.linear) v = linear(rng);
+	if(!b.linear.empty())
+		b.linear[0] = std::numeric_limits<float>::quiet_NaN();
+}
+
+static std::vector<simd_level> available_levels() {
+	std::vector<simd_level> levels;
+	for(auto level : {simd_level::scalar, simd_level::sse2, simd_level::avx2}) {
+		if(level <= supported_simd_level())
+			levels.push_back(level);
+	}
+	return levels;
+}
+
+// Runs every level on width x height and compares against scalar.
+static bool verify(const kernel_case& c, bench_buffers& b, int width, int height) {
+	set_simd_level(simd_level::scalar);
+	auto ref_span = c.run(b, width, height);
+	std::vector<std::byte> reference(ref_span.begin(), ref_span.end());
+
+	bool ok = true;
+	for(auto level : available_levels()) {
+		if(level == simd_level::scalar)
+			continue;
+		std::fill(b.out8.begin(), b.out8.end(), std::uint8_t{0xcd});
+		std::fill(b.out_float.begin(), b.out_float.end(), -1.0f);
+		set_simd_level(level);
+		auto out = c.run(b, width, height);
+		if(out.size() != reference.size() || std::memcmp(out.data(), reference.data(), out.size()) != 0) {
+			std::cerr << "MISMATCH " << c.name << "/" << simd_level_name(level) << " at "
+				<< width << "x" << height << "\n";
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+int main(int argc, char* argv[]) {
+	std::string_view filter;
+	double min_time = 0.2;
+	for(int i = 1; i + 1 < argc; i += 2) {
+		std::string_view arg = argv[i];
+		if(arg == "--filter")
+			filter = argv[i + 1];
+		else if(arg == "--min-time")
+			min_time = std::atof(argv[i + 1]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [--filter <substring>] [--min-time <seconds>]\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	const int sizes[] = {64, 256, 1024, 2048};
+	// odd and degenerate sizes only checked for correctness
+	const int check_sizes[][2] = {{1, 1}, {1, 9}, {9, 1}, {3, 3}, {17, 5}, {67, 45}, {130, 33}};
+
+	bench_buffers buffers;
+	fill_buffers(buffers, pixel_count(sizes[std::size(sizes) - 1], sizes[std::size(sizes) - 1]));
+
+	std::cout << "cpu supports " << simd_level_name(supported_simd_level()) << "\n";
+	std::cout << std::left << std::setw(36) << "Benchmark" << std::right << std::setw(14) << "Time"
+		<< std::setw(12) << "Iterations" << std::setw(12) << "GB/s" << "\n";
+	std::cout << std::string(74, '-') << "\n";
+
+	bool ok = true;
+	for(const auto& c : cases) {
+		if(!filter.empty() && std::string_view(c.name).find(filter) == std::string_view::npos)
+			continue;
+
+		for(const auto& size : check_sizes)
+			ok &= verify(c, buffers, size[0], size[1]);
+
+		for(int size : sizes) {
+			ok &= verify(c, buffers, size, size);
+			for(auto level : available_levels()) {
+				set_simd_level(level);
+				c.run(buffers, size, size); // warm caches
+
+				std::size_t iterations = 0;
+				auto start = bench_clock::now();
+				std::chrono::duration<double> elapsed{};
+				do {
+					c.run(buffers, size, size);
+					++iterations;
+					elapsed = bench_clock::now() - start;
+				} while(elapsed.count() < min_time || iterations < 3);
+
+				const double seconds = elapsed.count() / static_cast<double>(iterations);
+				const double bytes = c.bytes_per_pixel * static_cast<double>(pixel_count(size, size));
+				std::string name = std::string(c.name) + "/" + simd_level_name(level) + "/"
+					+ std::to_string(size) + "x" + std::to_string(size);
+				std::cout << std::left << std::setw(36) << name << std::right
+					<< std::setw(11) << std::fixed << std::setprecision(1) << seconds * 1e6 << " us"
+					<< std::setw(12) << iterations
+					<< std::setw(12) << std::setprecision(2) << bytes / seconds / 1e9 << "\n";
+			}
+		}
+	}
+
+	set_simd_level(supported_simd_level());
+	if(!ok) {
+		std::cerr << "SIMD output differs from the scalar path\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,48 @@
+#include "texture_cache.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Builds or refreshes the texture cache for a set of images so the first
+// launch doesn't have to decode anything.
+int main(int argc, char* argv[]) {
+	if(argc < 3) {
+		std::cerr << "usage: " << argv[0] << " <cache dir> <image or directory>...\n";
+		return EXIT_FAILURE;
+	}
+
+	const std::string cache_dir = argv[1];
+	std::vector<std::string> sources;
+	for(int i = 2; i < argc; ++i) {
+		std::error_code ec;
+		if(fs::is_directory(argv[i], ec)) {
+			for(const auto& entry : fs::recursive_directory_iterator(argv[i], ec)) {
+				if(entry.is_regular_file())
+					sources.push_back(entry.path().string());
+			}
+		}
+		else
+			sources.emplace_back(argv[i]);
+	}
+
+	int fresh = 0, built = 0, failed = 0;
+	for(const auto& source : sources) {
+		auto cache_file = texture_cache_path(cache_dir, source);
+		if(check_texture_cache(source, cache_file) == texture_cache_status::fresh) {
+			++fresh;
+			continue;
+		}
+		if(write_texture_cache(source, cache_file))
+			++built;
+		else
+			++failed;
+	}
+
+	std::cout << built << " built, " << fresh << " up to date, " << failed << " failed\n";
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}